@@ -5,7 +5,16 @@ fn main() {
         .file("cpp/calc_expression.cpp") // 表达式计算源文件
         .file("cpp/calc_polynomial.cpp") // 多项式计算源文件
         .file("cpp/polynomial.cpp") // 多项式类实现源文件
+        .file("cpp/poly_multiply.cpp") // 稠密多项式乘法内核
+        .file("cpp/bigint.cpp") // 任意精度整数系数
+        .file("cpp/multipoint.cpp") // 子乘积树多点求值
+        .file("cpp/poly_simd.cpp") // 多项式系数数组的 SIMD 内核
+        .file("cpp/poly_arena.cpp") // 表达式求值的单调分配器
+        .file("cpp/expression_plan.cpp") // 编译后的多项式表达式
+        .file("cpp/result_cache.cpp") // 格式化结果的 LRU 缓存
+        .file("cpp/name_table.cpp") // 多项式名称的驻留表
         .include("cpp") // 包含目录
+        .std("c++17") // 系数类型模板使用 if constexpr
         .flag("/utf-8") // 支持 UTF-8 编码，注释使用中文
         .compile("hello_cpp" ); // 编译为静态库
 
@@ -14,6 +23,23 @@ fn main() {
     println!("cargo:rerun-if-changed=cpp/calc_polynomial.cpp");
     println!("cargo:rerun-if-changed=cpp/polynomial.cpp");
     println!("cargo:rerun-if-changed=cpp/polynomial.hpp");
+    println!("cargo:rerun-if-changed=cpp/poly_multiply.cpp");
+    println!("cargo:rerun-if-changed=cpp/poly_multiply.hpp");
+    println!("cargo:rerun-if-changed=cpp/bigint.cpp");
+    println!("cargo:rerun-if-changed=cpp/bigint.hpp");
+    println!("cargo:rerun-if-changed=cpp/coefficient.hpp");
+    println!("cargo:rerun-if-changed=cpp/multipoint.cpp");
+    println!("cargo:rerun-if-changed=cpp/multipoint.hpp");
+    println!("cargo:rerun-if-changed=cpp/poly_simd.cpp");
+    println!("cargo:rerun-if-changed=cpp/poly_simd.hpp");
+    println!("cargo:rerun-if-changed=cpp/poly_arena.cpp");
+    println!("cargo:rerun-if-changed=cpp/poly_arena.hpp");
+    println!("cargo:rerun-if-changed=cpp/expression_plan.cpp");
+    println!("cargo:rerun-if-changed=cpp/expression_plan.hpp");
+    println!("cargo:rerun-if-changed=cpp/result_cache.cpp");
+    println!("cargo:rerun-if-changed=cpp/result_cache.hpp");
+    println!("cargo:rerun-if-changed=cpp/name_table.cpp");
+    println!("cargo:rerun-if-changed=cpp/name_table.hpp");
     println!("cargo:rerun-if-changed=cpp/stack.hpp");
 
     tauri_build::build()
@@ -0,0 +1,103 @@
+// 小多项式与短栈的堆分配次数基准: 统计每次操作调用 operator new 的次数和耗时
+// 由 CMakeLists.txt 的 small_alloc 目标构建 (build.rs 不编译):
+//   cmake -S src-tauri/cpp -B build && cmake --build build --target small_alloc
+// 用法: ./small_alloc
+//   表达式在 a..d 为 1-2 项的多项式上计算; 关闭结果缓存, 每次都实际求值
+//   表达式一项的分配次数包括结果字符串
+
+#include "polynomial.hpp"
+#include "stack.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+
+using namespace std;
+
+static size_t g_allocations = 0;
+
+void* operator new(size_t size) {
+    ++g_allocations;
+    if (void* p = malloc(size ? size : 1)) {
+        return p;
+    }
+    throw bad_alloc();
+}
+
+void* operator new[](size_t size) {
+    ++g_allocations;
+    if (void* p = malloc(size ? size : 1)) {
+        return p;
+    }
+    throw bad_alloc();
+}
+
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+void operator delete[](void* p, size_t) noexcept { free(p); }
+
+namespace {
+
+constexpr int ROUNDS = 20000;
+
+// 运行 ROUNDS 次, 输出每次的分配次数和耗时
+template <typename F>
+void measure(const char* label, F body) {
+    body();  // 预热: 线程局部的分配器、缓存等只在第一次创建
+    size_t before = g_allocations;
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < ROUNDS; ++i) {
+        body();
+    }
+    double us = chrono::duration<double, micro>(chrono::steady_clock::now() - start).count() / ROUNDS;
+    printf("%-28s allocs/op %6.1f  %8.3f us\n", label, double(g_allocations - before) / ROUNDS, us);
+}
+
+} // namespace
+
+int main() {
+    measure("Polynomial 2 terms", [] {
+        Polynomial p;
+        p.add_term(Term(3, 2));
+        p.add_term(Term(1, 0));
+    });
+
+    Polynomial binomial;
+    binomial.add_term(Term(3, 2));
+    binomial.add_term(Term(1, 0));
+    measure("Polynomial copy", [&] {
+        Polynomial copy(binomial);
+        (void)copy;
+    });
+    measure("Polynomial (2 terms)^2", [&] {
+        Polynomial square = binomial * binomial;
+        (void)square;
+    });
+
+    measure("Stack<int> depth 8", [] {
+        Stack<int> stack;
+        for (int i = 0; i < 8; ++i) {
+            stack.push(i);
+        }
+        while (!stack.empty()) {
+            stack.pop();
+        }
+    });
+
+    PolynomialManager::set_cache_budget(0);
+    PolynomialManager::create_polynomial('a', "3,2,1,0");
+    PolynomialManager::create_polynomial('b', "2,1");
+    PolynomialManager::create_polynomial('c', "1,1,-1,0");
+    PolynomialManager::create_polynomial('d', "5,0");
+    const char* expressions[] = {"(a+b)*c-d", "a*b", "a+b+c+d", "(a-b)*(c+d)"};
+    for (const char* expr : expressions) {
+        string expr_str(expr);
+        measure(expr, [&] {
+            string result;
+            PolynomialManager::calculate_polynomials(expr_str, result);
+        });
+    }
+    return 0;
+}
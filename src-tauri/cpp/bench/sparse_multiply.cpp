@@ -0,0 +1,138 @@
+// 稀疏多项式乘法基准: Polynomial::operator* 与原来逐项 add_term 的实现对比
+// 由 CMakeLists.txt 的 sparse_multiply 目标构建 (build.rs 不编译):
+//   cmake -S src-tauri/cpp -B build && cmake --build build --target sparse_multiply
+// 用法: ./sparse_multiply [spread] [n ...]
+//   每个操作数 n 项, 指数在 [0, spread * n) 中随机选取 (互不相同), 系数为 1-9
+//   spread 大时乘积的指数范围超过 n * n, 走堆归并; spread 小时走按指数累加的数组
+//   默认 spread = 10000, n = 40 80 1000 10000; 原来的实现只在 n <= 80 时运行
+//   乘积的指数不能超出 int, 因此要求 2 * spread * n <= INT_MAX
+
+#include "polynomial.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <climits>
+#include <cstdlib>
+#include <random>
+#include <set>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+// 原来的实现只在 n 不超过这个值时运行 (80 x 80 需要约一分钟)
+constexpr int BASELINE_LIMIT = 80;
+
+struct Operand {
+    vector<int> coefficients;
+    vector<int> exponents;  // 降序
+};
+
+Operand generate(int n, long long spread, unsigned seed) {
+    mt19937 rng(seed);
+    set<long long, greater<long long>> exps;
+    while (static_cast<int>(exps.size()) < n) {
+        exps.insert(static_cast<long long>(rng() % static_cast<unsigned long long>(spread * n)));
+    }
+
+    Operand op;
+    for (long long e : exps) {
+        op.coefficients.push_back(static_cast<int>(1 + rng() % 9));
+        op.exponents.push_back(static_cast<int>(e));
+    }
+    return op;
+}
+
+// 原来的 operator*: 每个交叉项经 add_term 加入, add_term 每次对整个结果冒泡排序并合并同类项
+vector<pair<int, int>> baseline_multiply(const Operand& lhs, const Operand& rhs) {
+    vector<pair<int, int>> result;  // (系数, 指数)
+    for (size_t i = 0; i < lhs.exponents.size(); ++i) {
+        for (size_t j = 0; j < rhs.exponents.size(); ++j) {
+            result.emplace_back(lhs.coefficients[i] * rhs.coefficients[j], lhs.exponents[i] + rhs.exponents[j]);
+
+            for (size_t a = 0; a + 1 < result.size(); ++a) {
+                for (size_t b = 0; b + 1 < result.size() - a; ++b) {
+                    if (result[b].second < result[b + 1].second) {
+                        swap(result[b], result[b + 1]);
+                    }
+                }
+            }
+
+            size_t w = 0;
+            for (size_t r = 0; r < result.size(); ++r) {
+                if (w > 0 && result[w - 1].second == result[r].second) {
+                    result[w - 1].first += result[r].first;
+                } else {
+                    result[w++] = result[r];
+                }
+            }
+            result.resize(w);
+            result.erase(remove_if(result.begin(), result.end(), [](const pair<int, int>& t) { return t.first == 0; }),
+                         result.end());
+        }
+    }
+    return result;
+}
+
+// 逐项合并构建操作数, 不经过 add_term 的逐次排序
+Polynomial build(const Operand& op) {
+    Polynomial result;
+    for (size_t i = 0; i < op.exponents.size(); ++i) {
+        Polynomial term(1);
+        term.add_term(Term(op.coefficients[i], op.exponents[i]));
+        result += term;
+    }
+    return result;
+}
+
+double elapsed_ms(chrono::steady_clock::time_point start) {
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    long long spread = argc > 1 ? atoll(argv[1]) : 10000;
+    vector<int> sizes;
+    for (int i = 2; i < argc; ++i) {
+        sizes.push_back(atoi(argv[i]));
+    }
+    if (sizes.empty()) {
+        sizes = {40, 80, 1000, 10000};
+    }
+
+    printf("spread %lld\n", spread);
+    for (int n : sizes) {
+        if (n <= 0 || spread <= 0 || 2 * spread * n > INT_MAX) {
+            printf("%d: spread * n out of range\n", n);
+            continue;
+        }
+
+        Operand lhs = generate(n, spread, 1);
+        Operand rhs = generate(n, spread, 2);
+
+        Polynomial a = build(lhs);
+        Polynomial b = build(rhs);
+
+        auto start = chrono::steady_clock::now();
+        Polynomial product = a * b;
+        double current_ms = elapsed_ms(start);
+        printf("%6d x %-6d operator*  %10.2f ms  %9d terms\n", n, n, current_ms, product.get_term_count());
+
+        if (n <= BASELINE_LIMIT) {
+            start = chrono::steady_clock::now();
+            vector<pair<int, int>> reference = baseline_multiply(lhs, rhs);
+            double baseline_ms = elapsed_ms(start);
+            bool same = static_cast<int>(reference.size()) == product.get_term_count();
+            for (int k = 0; same && k < product.get_term_count(); ++k) {
+                same = reference[k].first == product.get_term(k).get_coefficient() &&
+                       reference[k].second == product.get_term(k).get_exponent();
+            }
+            printf("%6d x %-6d baseline   %10.2f ms  %9zu terms%s\n", n, n, baseline_ms, reference.size(),
+                   same ? "" : "  (MISMATCH)");
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,213 @@
+#include "bigint.hpp"
+
+#include <algorithm>
+
+using namespace std;
+
+// ============================================================================
+// BigInt类实现
+// ============================================================================
+
+BigInt::BigInt() : negative_(false) {
+}
+
+BigInt::BigInt(long long value) : negative_(value < 0) {
+    uint64_t magnitude = value < 0 ? 0 - static_cast<uint64_t>(value) : static_cast<uint64_t>(value);
+    while (magnitude != 0) {
+        limbs_.push_back(static_cast<uint32_t>(magnitude));
+        magnitude >>= 32;
+    }
+}
+
+void BigInt::trim() {
+    while (!limbs_.empty() && limbs_.back() == 0) {
+        limbs_.pop_back();
+    }
+    if (limbs_.empty()) {
+        negative_ = false;
+    }
+}
+
+int BigInt::compare_magnitude(const vector<uint32_t>& a, const vector<uint32_t>& b) {
+    if (a.size() != b.size()) {
+        return a.size() < b.size() ? -1 : 1;
+    }
+    for (size_t i = a.size(); i-- > 0;) {
+        if (a[i] != b[i]) {
+            return a[i] < b[i] ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+void BigInt::add_magnitude(vector<uint32_t>& acc, const vector<uint32_t>& other) {
+    if (acc.size() < other.size()) {
+        acc.resize(other.size(), 0);
+    }
+    uint64_t carry = 0;
+    for (size_t i = 0; i < acc.size(); ++i) {
+        uint64_t sum = carry + acc[i] + (i < other.size() ? other[i] : 0);
+        acc[i] = static_cast<uint32_t>(sum);
+        carry = sum >> 32;
+        if (carry == 0 && i >= other.size()) {
+            break;
+        }
+    }
+    if (carry != 0) {
+        acc.push_back(static_cast<uint32_t>(carry));
+    }
+}
+
+void BigInt::sub_magnitude(vector<uint32_t>& acc, const vector<uint32_t>& other) {
+    int64_t borrow = 0;
+    for (size_t i = 0; i < acc.size(); ++i) {
+        int64_t diff = static_cast<int64_t>(acc[i]) - borrow - (i < other.size() ? other[i] : 0);
+        borrow = diff < 0 ? 1 : 0;
+        acc[i] = static_cast<uint32_t>(diff + (borrow << 32));
+        if (borrow == 0 && i >= other.size()) {
+            break;
+        }
+    }
+}
+
+vector<uint32_t> BigInt::mul_magnitude(const vector<uint32_t>& a, const vector<uint32_t>& b) {
+    if (a.empty() || b.empty()) {
+        return vector<uint32_t>();
+    }
+    vector<uint32_t> result(a.size() + b.size(), 0);
+    for (size_t i = 0; i < a.size(); ++i) {
+        uint64_t carry = 0;
+        for (size_t j = 0; j < b.size(); ++j) {
+            uint64_t cur = static_cast<uint64_t>(a[i]) * b[j] + result[i + j] + carry;
+            result[i + j] = static_cast<uint32_t>(cur);
+            carry = cur >> 32;
+        }
+        size_t k = i + b.size();
+        while (carry != 0) {
+            uint64_t cur = static_cast<uint64_t>(result[k]) + carry;
+            result[k++] = static_cast<uint32_t>(cur);
+            carry = cur >> 32;
+        }
+    }
+    return result;
+}
+
+void BigInt::add_signed(const vector<uint32_t>& other, bool other_negative) {
+    if (negative_ == other_negative) {
+        add_magnitude(limbs_, other);
+    } else if (compare_magnitude(limbs_, other) >= 0) {
+        sub_magnitude(limbs_, other);
+    } else {
+        vector<uint32_t> tmp = other;
+        sub_magnitude(tmp, limbs_);
+        limbs_.swap(tmp);
+        negative_ = other_negative;
+    }
+    trim();
+}
+
+BigInt& BigInt::operator+=(const BigInt& other) {
+    add_signed(other.limbs_, other.negative_);
+    return *this;
+}
+
+BigInt& BigInt::operator-=(const BigInt& other) {
+    add_signed(other.limbs_, !other.negative_);
+    return *this;
+}
+
+BigInt& BigInt::operator*=(const BigInt& other) {
+    *this = *this * other;
+    return *this;
+}
+
+BigInt BigInt::operator-() const {
+    BigInt result(*this);
+    if (!result.limbs_.empty()) {
+        result.negative_ = !result.negative_;
+    }
+    return result;
+}
+
+int64_t BigInt::low_int64() const {
+    uint64_t low = 0;
+    if (!limbs_.empty()) {
+        low = limbs_[0];
+    }
+    if (limbs_.size() > 1) {
+        low |= static_cast<uint64_t>(limbs_[1]) << 32;
+    }
+    return static_cast<int64_t>(negative_ ? 0 - low : low);
+}
+
+// 解析十进制整数: 每 9 位一组, 绝对值 = 绝对值 * 10^9 + 组值
+bool BigInt::parse(string_view text, BigInt& result) {
+    size_t pos = 0;
+    bool negative = false;
+    if (pos < text.size() && (text[pos] == '+' || text[pos] == '-')) {
+        negative = text[pos] == '-';
+        ++pos;
+    }
+    if (pos >= text.size()) {
+        return false;
+    }
+
+    vector<uint32_t> limbs;
+    while (pos < text.size()) {
+        uint32_t chunk = 0;
+        uint64_t scale = 1;
+        for (int digits = 0; digits < 9 && pos < text.size(); ++digits, ++pos) {
+            char c = text[pos];
+            if (c < '0' || c > '9') {
+                return false;
+            }
+            chunk = chunk * 10 + static_cast<uint32_t>(c - '0');
+            scale *= 10;
+        }
+        uint64_t carry = chunk;
+        for (size_t i = 0; i < limbs.size(); ++i) {
+            uint64_t cur = static_cast<uint64_t>(limbs[i]) * scale + carry;
+            limbs[i] = static_cast<uint32_t>(cur);
+            carry = cur >> 32;
+        }
+        if (carry != 0) {
+            limbs.push_back(static_cast<uint32_t>(carry));
+        }
+    }
+
+    result.limbs_.swap(limbs);
+    result.negative_ = negative;
+    result.trim();
+    return true;
+}
+
+// 十进制输出: 反复除以 10^9 取余
+string BigInt::to_string() const {
+    if (limbs_.empty()) {
+        return "0";
+    }
+
+    vector<uint32_t> magnitude = limbs_;
+    vector<uint32_t> chunks;
+    while (!magnitude.empty()) {
+        uint64_t remainder = 0;
+        for (size_t i = magnitude.size(); i-- > 0;) {
+            uint64_t cur = (remainder << 32) | magnitude[i];
+            magnitude[i] = static_cast<uint32_t>(cur / 1000000000u);
+            remainder = cur % 1000000000u;
+        }
+        chunks.push_back(static_cast<uint32_t>(remainder));
+        while (!magnitude.empty() && magnitude.back() == 0) {
+            magnitude.pop_back();
+        }
+    }
+
+    string result = negative_ ? "-" : "";
+    result += std::to_string(chunks.back());
+    for (size_t i = chunks.size() - 1; i-- > 0;) {
+        string part = std::to_string(chunks[i]);
+        result.append(9 - part.size(), '0');
+        result += part;
+    }
+    return result;
+}
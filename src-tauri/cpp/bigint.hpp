@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace std;
+
+// BigInt类: 任意精度有符号整数, 用作多项式系数
+// 符号 + 绝对值表示, 绝对值按 2^32 进制小端存放且无前导零, 零的绝对值为空
+class BigInt {
+private:
+    bool negative_;          // 是否为负数 (零始终为非负)
+    vector<uint32_t> limbs_; // 绝对值
+
+    // 比较绝对值: -1 小于, 0 相等, 1 大于
+    static int compare_magnitude(const vector<uint32_t>& a, const vector<uint32_t>& b);
+
+    // acc += other (绝对值)
+    static void add_magnitude(vector<uint32_t>& acc, const vector<uint32_t>& other);
+
+    // acc -= other (绝对值, 要求 |acc| >= |other|)
+    static void sub_magnitude(vector<uint32_t>& acc, const vector<uint32_t>& other);
+
+    // 绝对值相乘
+    static vector<uint32_t> mul_magnitude(const vector<uint32_t>& a, const vector<uint32_t>& b);
+
+    // 带符号加法: *this += (other_negative ? -|other| : |other|)
+    void add_signed(const vector<uint32_t>& other, bool other_negative);
+
+    // 去掉前导零, 零规范为非负
+    void trim();
+
+public:
+
+    BigInt();
+
+    BigInt(long long value);
+
+    // 解析十进制整数 (可带正负号), 失败返回 false
+    static bool parse(string_view text, BigInt& result);
+
+    // 十进制字符串
+    string to_string() const;
+
+    bool is_zero() const { return limbs_.empty(); }
+
+    bool is_negative() const { return negative_; }
+
+    // 按补码截断到 64 位
+    int64_t low_int64() const;
+
+    BigInt operator-() const;
+
+    BigInt& operator+=(const BigInt& other);
+
+    BigInt& operator-=(const BigInt& other);
+
+    BigInt& operator*=(const BigInt& other);
+
+    friend BigInt operator+(BigInt lhs, const BigInt& rhs) { return lhs += rhs; }
+
+    friend BigInt operator-(BigInt lhs, const BigInt& rhs) { return lhs -= rhs; }
+
+    friend BigInt operator*(const BigInt& lhs, const BigInt& rhs) {
+        BigInt result;
+        result.limbs_ = mul_magnitude(lhs.limbs_, rhs.limbs_);
+        result.negative_ = lhs.negative_ != rhs.negative_;
+        result.trim();
+        return result;
+    }
+
+    friend bool operator==(const BigInt& lhs, const BigInt& rhs) {
+        return lhs.negative_ == rhs.negative_ && lhs.limbs_ == rhs.limbs_;
+    }
+
+    friend bool operator!=(const BigInt& lhs, const BigInt& rhs) { return !(lhs == rhs); }
+
+    friend bool operator<(const BigInt& lhs, const BigInt& rhs) {
+        if (lhs.negative_ != rhs.negative_) {
+            return lhs.negative_;
+        }
+        int cmp = compare_magnitude(lhs.limbs_, rhs.limbs_);
+        return lhs.negative_ ? cmp > 0 : cmp < 0;
+    }
+
+    friend bool operator>(const BigInt& lhs, const BigInt& rhs) { return rhs < lhs; }
+};
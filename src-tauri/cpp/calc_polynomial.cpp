@@ -1,4 +1,5 @@
 #include "polynomial.hpp"
+#include <cstdint>
 #include <cstring>
 #include <iostream>
 #include <memory>
@@ -15,12 +16,20 @@ static constexpr int ERROR_SUCCESS = 0;
 static constexpr int ERROR_INVALID_NAME = -1;
 static constexpr int ERROR_POLYNOMIAL_NOT_FOUND = -2;
 static constexpr int ERROR_INVALID_INPUT = -3;
-static constexpr int ERROR_TOO_MANY_POLYNOMIALS = -4;
+static constexpr int ERROR_RESERVED = -4; // 原 "数量超过上限", 多项式数量已不受限制, 不再返回
 static constexpr int ERROR_EMPTY_EXPRESSION = -5;
 static constexpr int ERROR_EXPRESSION_PARSE_ERROR = -6;
 static constexpr int ERROR_INVALID_EXPRESSION = -7;
 static constexpr int ERROR_PARENTHESES_MISMATCH = -8;
 static constexpr int ERROR_INVALID_CHARACTER = -9;
+static constexpr int ERROR_MALFORMED_INPUT = -10;
+
+// create_polynomial_from_terms 的 flags: 指数已严格递减, 同类项已合并
+static constexpr int TERMS_CANONICAL = 1;
+
+// write_* 接口的 format
+static constexpr int OUTPUT_STANDARD = 0;    // 标准格式 "n,c1,e1,..."
+static constexpr int OUTPUT_WITH_LATEX = 1;  // "标准格式|LaTeX 格式", 与 *_with_latex 接口相同
 
 // ============================================================================
 // 辅助函数实现
@@ -28,6 +37,13 @@ static constexpr int ERROR_INVALID_CHARACTER = -9;
 static bool is_valid_polynomial_name(char name);
 static bool is_valid_operator(char op);
 static int get_operator_precedence(char op);
+static int prepare_expression(const char* expression, string& expr_str);
+static int prepare_named_expression(const char* expression, string& expr_str);
+static int expression_error(int status);
+static int input_error(int status);
+static int copy_output(const string& result, char* output, int buffer_size);
+static int check_output(int format, char* output, long long buffer_size, long long* length);
+static int check_terms_output(int64_t* coefficients, int64_t* exponents, long long capacity, int stride, long long* count);
 
 
 // 检查多项式名称是否合法
@@ -56,6 +72,111 @@ static int get_operator_precedence(char op) {
     }
 }
 
+// 检查只引用 'a'-'e' 的旧表达式: 名称都是单个字母, 空白统一为空格, 相邻的两个名称之间补一个空格,
+// 使 "ab" 与 "a b" 都按两个相邻的操作数报表达式错误, 而不是被当作名称 "ab"
+static int prepare_expression(const char* expression, string& expr_str) {
+    expr_str.clear();
+
+    bool empty = true;
+    for (const char* p = expression; *p; ++p) {
+        char c = *p;
+        if (isspace(static_cast<unsigned char>(c))) {
+            expr_str += ' ';
+            continue;
+        }
+        empty = false;
+        if (!is_valid_polynomial_name(c) && !is_valid_operator(c)) {
+            return ERROR_INVALID_CHARACTER;
+        }
+        if (is_valid_polynomial_name(c) && !expr_str.empty() && is_valid_polynomial_name(expr_str.back())) {
+            expr_str += ' ';
+        }
+        expr_str += c;
+    }
+
+    return empty ? ERROR_EMPTY_EXPRESSION : ERROR_SUCCESS;
+}
+
+// 检查引用任意名称的表达式, 名称按 NameTable 的标识符规则 (字母或下划线开头, 之后为字母、数字或下划线),
+// 其余只允许运算符、括号和空白; 空白统一为空格后保留 (相邻的两个名称不会被拼成一个)
+static int prepare_named_expression(const char* expression, string& expr_str) {
+    expr_str = expression;
+
+    bool empty = true;
+    for (size_t i = 0; i < expr_str.size(); ++i) {
+        char c = expr_str[i];
+        if (isspace(static_cast<unsigned char>(c))) {
+            expr_str[i] = ' ';
+            continue;
+        }
+        empty = false;
+        if (NameTable::is_identifier_start(c)) {
+            while (i + 1 < expr_str.size() && NameTable::is_identifier_char(expr_str[i + 1])) {
+                ++i;
+            }
+        } else if (!is_valid_operator(c)) {
+            return ERROR_INVALID_CHARACTER; // 包括不在名称中的数字
+        }
+    }
+
+    return empty ? ERROR_EMPTY_EXPRESSION : ERROR_SUCCESS;
+}
+
+// 把多项式工作区计算表达式的返回值换成本文件的错误码 (新接口使用; 旧接口保持原来直接返回的值)
+static int expression_error(int status) {
+    switch (status) {
+        case -4:
+            return ERROR_EMPTY_EXPRESSION;
+        case -5:
+            return ERROR_POLYNOMIAL_NOT_FOUND;
+        case -7:
+            return ERROR_PARENTHESES_MISMATCH;
+        case -8:
+            return ERROR_INVALID_CHARACTER;
+        default:
+            return status; // 0, -3 (系数超出 int64 范围, 即 ERROR_INVALID_INPUT), -6 与本文件相同
+    }
+}
+
+// 把多项式工作区创建多项式的返回值换成本文件的错误码: 工作区的 -2 (输入解析失败或数据不合法) 换成 ERROR_MALFORMED_INPUT,
+// 不与 ERROR_POLYNOMIAL_NOT_FOUND 混淆
+static int input_error(int status) {
+    return status == -2 ? ERROR_MALFORMED_INPUT : status; // 0, -1 与本文件相同
+}
+
+// 把结果复制到调用方的缓冲区
+static int copy_output(const string& result, char* output, int buffer_size) {
+    if (result.length() >= static_cast<size_t>(buffer_size)) {
+        return ERROR_INVALID_INPUT;
+    }
+    strcpy(output, result.c_str());
+    return ERROR_SUCCESS;
+}
+
+// 检查 write_* 接口的参数, 并把 *length 置为 0
+static int check_output(int format, char* output, long long buffer_size, long long* length) {
+    if (!length) {
+        return ERROR_INVALID_INPUT;
+    }
+    *length = 0;
+    if ((format != OUTPUT_STANDARD && format != OUTPUT_WITH_LATEX) || buffer_size < 0 || (buffer_size > 0 && !output)) {
+        return ERROR_INVALID_INPUT;
+    }
+    return ERROR_SUCCESS;
+}
+
+// 检查 *_terms 接口的参数, 并把 *count 置为 0
+static int check_terms_output(int64_t* coefficients, int64_t* exponents, long long capacity, int stride, long long* count) {
+    if (!count) {
+        return ERROR_INVALID_INPUT;
+    }
+    *count = 0;
+    if (capacity < 0 || stride < 1 || (capacity > 0 && (!coefficients || !exponents))) {
+        return ERROR_INVALID_INPUT;
+    }
+    return ERROR_SUCCESS;
+}
+
 // ============================================================================
 // C 接口实现
 // ============================================================================
@@ -66,7 +187,7 @@ extern "C" {
  * @brief 多项式构建
  * @param name 多项式名称 ('a'-'e')
  * @param input 用户输入 format: "c1,e1,c2,e2,..."
- * @return 0: success, other: error code
+ * @return 0: success, ERROR_MALFORMED_INPUT: 输入格式错误, other: error code
  */
 int create_polynomial(char name, const char* input) {
     if (!is_valid_polynomial_name(name)) {
@@ -78,7 +199,7 @@ int create_polynomial(char name, const char* input) {
     }
 
     string input_str(input);
-    return PolynomialManager::create_polynomial(name, input_str);
+    return input_error(active_polynomial_engine().create_polynomial(name, input_str));
 }
 
 /**
@@ -98,7 +219,7 @@ int get_polynomial_to_string(char name, char* output, int buffer_size) {
     }
 
     string result;
-    int ret = PolynomialManager::get_polynomial_string(name, result);
+    int ret = active_polynomial_engine().get_polynomial_string(name, result);
 
     if (ret == ERROR_SUCCESS) {
         if (result.length() >= static_cast<size_t>(buffer_size)) {
@@ -126,40 +247,305 @@ int calculate_polynomials(const char* expression, char* output, int buffer_size)
         return ERROR_INVALID_INPUT;
     }
 
-    string expr_str(expression);
+    string expr_str;
+    int ret = prepare_expression(expression, expr_str);
+    if (ret != ERROR_SUCCESS) {
+        return ret;
+    }
+
+    string result;
+    ret = active_polynomial_engine().calculate_polynomials(expr_str, result);
+
+    if (ret == ERROR_SUCCESS) {
+        if (result.length() >= static_cast<size_t>(buffer_size)) {
+            return ERROR_INVALID_INPUT;
+        }
+        strcpy(output, result.c_str());
+    }
+
+    return ret;
+}
+
+/**
+ * @brief 按任意名称构建多项式, 数量不限, 同名时替换
+ * @param name 多项式名称, 字母或下划线开头, 之后为字母、数字或下划线 (e.g. "p1", "rate_2")
+ * @param input 用户输入 format: "c1,e1,c2,e2,..."
+ * @return 0: success, ERROR_MALFORMED_INPUT: 输入格式错误, other: error code
+ */
+int create_named_polynomial(const char* name, const char* input) {
+    if (!name) {
+        return ERROR_INVALID_NAME;
+    }
+
+    if (!input) {
+        return ERROR_INVALID_INPUT;
+    }
+
+    return input_error(active_polynomial_engine().create_named_polynomial(name, input));
+}
+
+/**
+ * @brief 按任意名称构建多项式, 输入格式错误时给出出错位置; 一次扫描解析, 适合项数很多的输入
+ * @param name 多项式名称, 规则同 create_named_polynomial
+ * @param input 用户输入 format: "c1,e1,c2,e2,...", 数字前后可以有空白, 同一指数出现多次时系数相加
+ * @param error_offset 输出: 返回 ERROR_MALFORMED_INPUT 时为出错处在 input 中的字节偏移, 其他情况为 -1; 可以为 NULL
+ * @return 0: success, ERROR_MALFORMED_INPUT (-10): 输入格式错误, other: error code
+ */
+int load_named_polynomial(const char* name, const char* input, long long* error_offset) {
+    if (error_offset) {
+        *error_offset = -1;
+    }
+
+    if (!name) {
+        return ERROR_INVALID_NAME;
+    }
+
+    if (!input) {
+        return ERROR_INVALID_INPUT;
+    }
+
+    size_t offset = 0;
+    int ret = input_error(active_polynomial_engine().create_named_polynomial(name, input, &offset));
+    if (ret == ERROR_MALFORMED_INPUT && error_offset) {
+        *error_offset = static_cast<long long>(offset);
+    }
+    return ret;
+}
+
+/**
+ * @brief 由 64 位整数数组按名称构建多项式, 不经过文本格式化与解析
+ *        第 i 项为 coefficients[i * stride] * x^exponents[i * stride]: 系数与指数分成两个数组时 stride = 1;
+ *        交错存放的 terms = {c0, e0, c1, e1, ...} 传 coefficients = terms, exponents = terms + 1, stride = 2
+ * @param name 多项式名称, 规则同 create_named_polynomial
+ * @param coefficients 系数数组 (当前系数类型为 32 位整数时须在其范围内, 模素数类型按模取余)
+ * @param exponents 指数数组, 须在 32 位整数范围内
+ * @param count 项数
+ * @param stride 相邻两项在数组中的间隔 (元素个数, >= 1)
+ * @param flags TERMS_CANONICAL (1): 指数已严格递减且同类项已合并, 跳过排序与合并; 0: 任意顺序, 同类项系数相加
+ * @param error_index 输出: 返回 ERROR_MALFORMED_INPUT 时为出错项的下标, 其他情况为 -1; 可以为 NULL
+ * @return 0: success, ERROR_MALFORMED_INPUT (-10): 数据不合法 (超出范围, 或 flags 为 1 而指数不严格递减),
+ *         other: error code
+ */
+int create_polynomial_from_terms(const char* name, const int64_t* coefficients, const int64_t* exponents, long long count,
+                                 int stride, int flags, long long* error_index) {
+    if (error_index) {
+        *error_index = -1;
+    }
+
+    if (!name) {
+        return ERROR_INVALID_NAME;
+    }
+
+    if (count < 0 || stride < 1 || (flags & ~TERMS_CANONICAL) != 0 || (count > 0 && (!coefficients || !exponents))) {
+        return ERROR_INVALID_INPUT;
+    }
+
+    size_t index = 0;
+    int ret = input_error(active_polynomial_engine().create_named_polynomial_from_terms(
+        name, coefficients, exponents, static_cast<size_t>(count), static_cast<size_t>(stride),
+        (flags & TERMS_CANONICAL) != 0, &index));
+    if (ret == ERROR_MALFORMED_INPUT && error_index) {
+        *error_index = static_cast<long long>(index);
+    }
+    return ret;
+}
+
+/**
+ * @brief 按名称得到标准输出字符串
+ * @param name 多项式名称
+ * @param output 指针输出
+ * @param buffer_size 缓冲区大小
+ * @return 0: success, other: error code
+ */
+int get_named_polynomial_to_string(const char* name, char* output, int buffer_size) {
+    if (!name) {
+        return ERROR_INVALID_NAME;
+    }
+
+    if (!output || buffer_size <= 0) {
+        return ERROR_INVALID_INPUT;
+    }
+
+    string result;
+    int ret = active_polynomial_engine().get_named_polynomial_string(name, result);
+
+    if (ret == ERROR_SUCCESS) {
+        ret = copy_output(result, output, buffer_size);
+    }
+
+    return ret;
+}
+
+/**
+ * @brief 计算引用任意名称的表达式, 名称取最长的标识符 (e.g. "p1*p2 + rate_2")
+ * @param expression 多项式表达式
+ * @param output 指针输出
+ * @param buffer_size 缓冲区大小
+ * @return 0: success, other: error code
+ */
+int calculate_named_expression(const char* expression, char* output, int buffer_size) {
+    if (!expression) {
+        return ERROR_EMPTY_EXPRESSION;
+    }
+
+    if (!output || buffer_size <= 0) {
+        return ERROR_INVALID_INPUT;
+    }
+
+    string expr_str;
+    int ret = prepare_named_expression(expression, expr_str);
+    if (ret != ERROR_SUCCESS) {
+        return ret;
+    }
+
+    string result;
+    ret = expression_error(active_polynomial_engine().calculate_polynomials(expr_str, result));
 
-    // 去除空格
-    expr_str.erase(remove_if(expr_str.begin(), expr_str.end(), ::isspace), expr_str.end());
+    if (ret == ERROR_SUCCESS) {
+        ret = copy_output(result, output, buffer_size);
+    }
 
-    if (expr_str.empty()) {
+    return ret;
+}
+
+// 当前系数类型保存的多项式个数
+long long get_polynomial_count() {
+    return static_cast<long long>(active_polynomial_engine().polynomial_count());
+}
+
+/**
+ * @brief 按当前绑定的多项式计算表达式, 输出实际的计算过程, 用于检查规划器选择的顺序
+ *        每行一步, 例如 "chain * (a, b, c)" 之后的 "  t1 = b * c  [2 x 3 terms, est cost 12 -> 6 terms]"
+ * @param expression 多项式表达式
+ * @param output 指针输出
+ * @param buffer_size 缓冲区大小
+ * @return 0: success, other: error code (与 calculate_named_expression 相同)
+ */
+int explain_polynomial_expression(const char* expression, char* output, int buffer_size) {
+    if (!expression) {
         return ERROR_EMPTY_EXPRESSION;
     }
 
-    // 非法字符判断
-    for (char c : expr_str) {
-        if (!is_valid_polynomial_name(c) && !is_valid_operator(c)) {
-            return ERROR_INVALID_CHARACTER;
-        }
+    if (!output || buffer_size <= 0) {
+        return ERROR_INVALID_INPUT;
+    }
+
+    string expr_str;
+    int ret = prepare_named_expression(expression, expr_str);
+    if (ret != ERROR_SUCCESS) {
+        return ret;
     }
 
     string result;
-    int ret = PolynomialManager::calculate_polynomials(expr_str, result);
+    ret = expression_error(active_polynomial_engine().explain_expression(expr_str, result));
 
     if (ret == ERROR_SUCCESS) {
-        if (result.length() >= static_cast<size_t>(buffer_size)) {
-            return ERROR_INVALID_INPUT;
-        }
-        strcpy(output, result.c_str());
+        ret = copy_output(result, output, buffer_size);
+    }
+
+    return ret;
+}
+
+/**
+ * @brief 编译多项式算数表达式, 之后用句柄反复计算, 解析和检查只做一次
+ *        计算时使用当时绑定的多项式, 编译后修改多项式不需要重新编译; 编译结果与系数类型无关
+ * @param expression 多项式表达式(e.g. "(a+b)*c-d", "p1*p2 + rate_2"), 名称规则同 calculate_named_expression
+ * @param handle 指针输出, 句柄 (正整数)
+ * @return 0: success, other: error code (与 calculate_named_expression 相同)
+ */
+int compile_polynomial_expression(const char* expression, int* handle) {
+    if (!expression) {
+        return ERROR_EMPTY_EXPRESSION;
+    }
+
+    if (!handle) {
+        return ERROR_INVALID_INPUT;
+    }
+
+    string expr_str;
+    int ret = prepare_named_expression(expression, expr_str);
+    if (ret != ERROR_SUCCESS) {
+        return ret;
+    }
+
+    shared_ptr<ExpressionPlan> plan = make_shared<ExpressionPlan>();
+    ret = expression_error(plan->compile(expr_str));
+    if (ret != ERROR_SUCCESS) {
+        return ret;
+    }
+
+    *handle = ExpressionPlanRegistry::instance().add(std::move(plan));
+    return ERROR_SUCCESS;
+}
+
+/**
+ * @brief 计算编译后的表达式
+ * @param handle compile_polynomial_expression 返回的句柄
+ * @param output 指针输出
+ * @param buffer_size 缓冲区大小
+ * @return 0: success, other: error code (与 calculate_named_expression 相同; 句柄不存在时为 ERROR_INVALID_INPUT)
+ */
+int calculate_compiled_expression(int handle, char* output, int buffer_size) {
+    if (!output || buffer_size <= 0) {
+        return ERROR_INVALID_INPUT;
+    }
+
+    shared_ptr<const ExpressionPlan> plan = ExpressionPlanRegistry::instance().find(handle);
+    if (!plan) {
+        return ERROR_INVALID_INPUT;
+    }
+
+    string result;
+    int ret = expression_error(active_polynomial_engine().calculate_compiled(*plan, result));
+
+    if (ret == ERROR_SUCCESS) {
+        ret = copy_output(result, output, buffer_size);
+    }
+
+    return ret;
+}
+
+/**
+ * @brief 计算编译后的表达式, 输出 "标准格式|LaTeX格式"
+ * @param handle compile_polynomial_expression 返回的句柄
+ * @param output 指针输出
+ * @param buffer_size 缓冲区大小
+ * @return 0: success, other: error code
+ */
+int calculate_compiled_expression_with_latex(int handle, char* output, int buffer_size) {
+    if (!output || buffer_size <= 0) {
+        return ERROR_INVALID_INPUT;
+    }
+
+    shared_ptr<const ExpressionPlan> plan = ExpressionPlanRegistry::instance().find(handle);
+    if (!plan) {
+        return ERROR_INVALID_INPUT;
+    }
+
+    string result;
+    int ret = expression_error(active_polynomial_engine().calculate_compiled_with_latex(*plan, result));
+
+    if (ret == ERROR_SUCCESS) {
+        ret = copy_output(result, output, buffer_size);
     }
 
     return ret;
 }
 
+/**
+ * @brief 释放编译后的表达式
+ * @param handle compile_polynomial_expression 返回的句柄
+ * @return 0: success, ERROR_INVALID_INPUT: 句柄不存在
+ */
+int release_compiled_expression(int handle) {
+    return ExpressionPlanRegistry::instance().remove(handle) ? ERROR_SUCCESS : ERROR_INVALID_INPUT;
+}
+
 /**
  * @brief 计算多项式在x值
  * @param name 多项式名称
  * @param x 
- * @param result 指针输出
+ * @param result 指针输出 (结果截断为 int, 完整结果见 evaluate_polynomial_to_string)
  * @return 0: success, other: error code
  */
 int evaluate_polynomial(char name, int x, int* result) {
@@ -171,7 +557,27 @@ int evaluate_polynomial(char name, int x, int* result) {
         return ERROR_INVALID_INPUT;
     }
 
-    return PolynomialManager::evaluate_polynomial(name, x, *result);
+    return active_polynomial_engine().evaluate_polynomial(name, x, *result);
+}
+
+/**
+ * @brief 批量计算多项式在多个x处的值
+ * @param name 多项式名称
+ * @param xs x 数组
+ * @param count x 的个数
+ * @param results 指针输出, 长度不小于 count (结果截断为 int)
+ * @return 0: success, other: error code
+ */
+int evaluate_polynomial_batch(char name, const int* xs, int count, int* results) {
+    if (!is_valid_polynomial_name(name)) {
+        return ERROR_INVALID_NAME;
+    }
+
+    if (count < 0 || (count > 0 && (!xs || !results))) {
+        return ERROR_INVALID_INPUT;
+    }
+
+    return active_polynomial_engine().evaluate_polynomial_batch(name, xs, count, results);
 }
 
 /**
@@ -191,7 +597,7 @@ int derivative_polynomial(char name, char* output, int buffer_size) {
     }
 
     string result;
-    int ret = PolynomialManager::derivative_polynomial(name, result);
+    int ret = active_polynomial_engine().derivative_polynomial(name, result);
 
     if (ret == ERROR_SUCCESS) {
         // Check buffer size
@@ -205,8 +611,89 @@ int derivative_polynomial(char name, char* output, int buffer_size) {
 }
 
 
+/**
+ * @brief 计算多项式在x值, 以十进制字符串输出 (不截断, 适用于 64 位 / 128 位 / 任意精度系数)
+ * @param name 多项式名称
+ * @param x
+ * @param output 指针输出
+ * @param buffer_size 缓冲区大小
+ * @return 0: success, other: error code
+ */
+int evaluate_polynomial_to_string(char name, int x, char* output, int buffer_size) {
+    if (!is_valid_polynomial_name(name)) {
+        return ERROR_INVALID_NAME;
+    }
+
+    if (!output || buffer_size <= 0) {
+        return ERROR_INVALID_INPUT;
+    }
+
+    string result;
+    int ret = active_polynomial_engine().evaluate_polynomial(name, x, result);
+
+    if (ret == ERROR_SUCCESS) {
+        if (result.length() >= static_cast<size_t>(buffer_size)) {
+            return ERROR_INVALID_INPUT;
+        }
+        strcpy(output, result.c_str());
+    }
+
+    return ret;
+}
+
+/**
+ * @brief 选择系数类型, 之后的所有接口都作用于该类型的多项式工作区
+ *        每种类型各自保存一组多项式, 切换类型不会转换或清除其他类型中的多项式
+ * @param kind 0: int (默认), 1: int64, 2: int128, 3: 模 998244353, 4: 任意精度整数
+ * @return 0: success, ERROR_INVALID_INPUT: 类型不存在或当前编译器不支持
+ */
+int set_polynomial_coefficient_type(int kind) {
+    if (set_active_coefficient_kind(kind) != 0) {
+        return ERROR_INVALID_INPUT;
+    }
+    return ERROR_SUCCESS;
+}
+
+// 当前系数类型
+int get_polynomial_coefficient_type() {
+    return active_coefficient_kind();
+}
+
 int clear_all_polynomials() {
-    PolynomialManager::clear_all();
+    active_polynomial_engine().clear_all();
+    return ERROR_SUCCESS;
+}
+
+/**
+ * @brief 设置当前系数类型的结果缓存预算
+ *        表达式, 导数和多项式字符串的格式化结果按 LRU 缓存, 创建多项式后引用它的旧结果自动失效
+ * @param bytes 预算 (字节), 0 表示关闭缓存, 默认 16 MiB
+ * @return 0: success, ERROR_INVALID_INPUT: 预算为负数
+ */
+int set_polynomial_cache_budget(long long bytes) {
+    if (bytes < 0) {
+        return ERROR_INVALID_INPUT;
+    }
+    active_polynomial_engine().set_cache_budget(static_cast<size_t>(bytes));
+    return ERROR_SUCCESS;
+}
+
+/**
+ * @brief 获取当前系数类型的结果缓存统计, 不需要的项可以传 NULL
+ * @param hits 命中次数
+ * @param misses 未命中次数
+ * @param entries 当前条目数
+ * @param bytes 当前占用 (估计值, 字节)
+ * @return 0: success
+ */
+int get_polynomial_cache_stats(long long* hits, long long* misses, long long* entries, long long* bytes) {
+    ResultCacheStats stats;
+    active_polynomial_engine().get_cache_stats(stats);
+
+    if (hits) *hits = static_cast<long long>(stats.hits);
+    if (misses) *misses = static_cast<long long>(stats.misses);
+    if (entries) *entries = static_cast<long long>(stats.entries);
+    if (bytes) *bytes = static_cast<long long>(stats.bytes);
     return ERROR_SUCCESS;
 }
 
@@ -222,7 +709,7 @@ int get_polynomial_names(char* names, int max_count) {
     }
 
     vector<char> name_list;
-    int count = PolynomialManager::get_polynomial_names(name_list);
+    int count = active_polynomial_engine().get_polynomial_names(name_list);
 
     if (count > max_count) {
         count = max_count;
@@ -241,7 +728,7 @@ int polynomial_exists(char name) {
     }
 
     string dummy;
-    int ret = PolynomialManager::get_polynomial_string(name, dummy);
+    int ret = active_polynomial_engine().get_polynomial_string(name, dummy);
     return (ret == ERROR_SUCCESS) ? 1 : 0;
 }
 
@@ -255,39 +742,448 @@ int get_polynomial_term_count(char name, int* count) {
         return ERROR_INVALID_INPUT;
     }
 
-    string result;
-    int ret = PolynomialManager::get_polynomial_string(name, result);
+    // 容量为 0 时只返回项数, 不格式化多项式
+    size_t term_count = 0;
+    int ret = active_polynomial_engine().get_named_polynomial_terms(string(1, name), nullptr, nullptr, 0, 1, term_count);
 
     if (ret == ERROR_SUCCESS) {
-        if (result == "0") {
-            *count = 0;
-        } else {
-            size_t first_comma = result.find(',');
-            if (first_comma != string::npos) {
-                string count_str = result.substr(0, first_comma);
-                *count = stoi(count_str);
-            } else {
-                *count = 0;
-            }
-        }
+        *count = static_cast<int>(term_count);
+    }
+
+    return ret;
+}
+
+// 以下 write_* 接口把文本结果写入调用方的缓冲区, 用法与 snprintf 相同: 返回 0 时 *length 为完整结果的长度
+// (不含结尾的 '\0'); *length < buffer_size 时 output 中为完整结果, 否则为截断的前缀 (buffer_size > 0 时以 '\0' 结尾),
+// 按 *length + 1 分配缓冲区后再调用一次即可. buffer_size 为 0 时 output 可以为 NULL, 只求长度.
+// 结果直接格式化到 output, 不经过中间字符串; 计算得到的多项式保留到下一次计算, 第二次调用只重新格式化, 不重新计算
+
+/**
+ * @brief 把多项式直接写入缓冲区, 数字用 to_chars 格式化, 不经过中间字符串
+ * @param name 多项式名称, 规则同 create_named_polynomial
+ * @param format OUTPUT_STANDARD (0): 标准格式; OUTPUT_WITH_LATEX (1): "标准格式|LaTeX 格式"
+ * @param output 指针输出
+ * @param buffer_size 缓冲区大小 (字节, 含结尾的 '\0')
+ * @param length 输出: 完整结果的长度
+ * @return 0: success, other: error code
+ */
+int write_polynomial_string(const char* name, int format, char* output, long long buffer_size, long long* length) {
+    int ret = check_output(format, output, buffer_size, length);
+    if (ret != ERROR_SUCCESS) {
+        return ret;
+    }
+
+    if (!name) {
+        return ERROR_INVALID_NAME;
+    }
+
+    TextWriter writer(output, static_cast<size_t>(buffer_size));
+    ret = active_polynomial_engine().write_named_polynomial(name, format == OUTPUT_WITH_LATEX, writer);
+    if (ret == ERROR_SUCCESS) {
+        writer.finish();
+        *length = static_cast<long long>(writer.length());
+    }
+    return ret;
+}
+
+/**
+ * @brief 计算表达式并把结果写入缓冲区, 名称规则同 calculate_named_expression
+ * @param expression 多项式表达式(e.g. "a+b", "p1*p2 + rate_2")
+ * @param format OUTPUT_STANDARD (0) 或 OUTPUT_WITH_LATEX (1)
+ * @param output 指针输出
+ * @param buffer_size 缓冲区大小
+ * @param length 输出: 完整结果的长度
+ * @return 0: success, ERROR_POLYNOMIAL_NOT_FOUND: 引用的多项式不存在, other: error code
+ */
+int write_calculation_result(const char* expression, int format, char* output, long long buffer_size, long long* length) {
+    int ret = check_output(format, output, buffer_size, length);
+    if (ret != ERROR_SUCCESS) {
+        return ret;
+    }
+
+    if (!expression) {
+        return ERROR_EMPTY_EXPRESSION;
+    }
+
+    string expr_str;
+    ret = prepare_named_expression(expression, expr_str);
+    if (ret != ERROR_SUCCESS) {
+        return ret;
+    }
+
+    TextWriter writer(output, static_cast<size_t>(buffer_size));
+    ret = expression_error(active_polynomial_engine().write_calculation(expr_str, format == OUTPUT_WITH_LATEX, writer));
+    if (ret == ERROR_SUCCESS) {
+        writer.finish();
+        *length = static_cast<long long>(writer.length());
+    }
+    return ret;
+}
+
+/**
+ * @brief 计算多项式导数并把结果写入缓冲区, 错误码同 derivative_polynomial
+ * @param name 多项式名称 ('a'-'e')
+ * @param format OUTPUT_STANDARD (0) 或 OUTPUT_WITH_LATEX (1)
+ * @param output 指针输出
+ * @param buffer_size 缓冲区大小
+ * @param length 输出: 完整结果的长度
+ * @return 0: success, other: error code
+ */
+int write_derivative_result(char name, int format, char* output, long long buffer_size, long long* length) {
+    int ret = check_output(format, output, buffer_size, length);
+    if (ret != ERROR_SUCCESS) {
+        return ret;
+    }
+
+    if (!is_valid_polynomial_name(name)) {
+        return ERROR_INVALID_NAME;
+    }
+
+    TextWriter writer(output, static_cast<size_t>(buffer_size));
+    ret = active_polynomial_engine().write_derivative(name, format == OUTPUT_WITH_LATEX, writer);
+    if (ret == ERROR_SUCCESS) {
+        writer.finish();
+        *length = static_cast<long long>(writer.length());
+    }
+    return ret;
+}
+
+/**
+ * @brief 按指数降序把多项式的各项写入 64 位整数数组, 不经过文本
+ *        第 i 项写到 coefficients[i * stride] 与 exponents[i * stride]; 交错输出 {c0, e0, c1, e1, ...} 时
+ *        传 coefficients = terms, exponents = terms + 1, stride = 2 (terms 至少有 2 * capacity 个元素)
+ * @param name 多项式名称, 规则同 create_named_polynomial
+ * @param coefficients 系数数组
+ * @param exponents 指数数组
+ * @param capacity 数组可以容纳的项数; 项数超过 capacity 时不写入, 只返回项数 (capacity 为 0 时数组可以为 NULL)
+ * @param stride 相邻两项在数组中的间隔 (元素个数, >= 1)
+ * @param count 输出: 项数
+ * @return 0: success, ERROR_INVALID_INPUT: 参数错误或有系数超出 int64 范围 (任意精度 / 128 位系数), other: error code
+ */
+int get_polynomial_terms(const char* name, int64_t* coefficients, int64_t* exponents, long long capacity, int stride,
+                         long long* count) {
+    int ret = check_terms_output(coefficients, exponents, capacity, stride, count);
+    if (ret != ERROR_SUCCESS) {
+        return ret;
+    }
+
+    if (!name) {
+        return ERROR_INVALID_NAME;
     }
 
+    size_t term_count = 0;
+    ret = active_polynomial_engine().get_named_polynomial_terms(name, coefficients, exponents, static_cast<size_t>(capacity),
+                                                               static_cast<size_t>(stride), term_count);
+    *count = static_cast<long long>(term_count);
     return ret;
 }
 
+/**
+ * @brief 计算表达式并按 get_polynomial_terms 的方式输出结果的各项, 表达式规则与错误码同 write_calculation_result
+ *        容量不足时只返回项数, 按项数分配后再次调用时复用保留的结果, 不重新计算
+ * @param expression 多项式表达式
+ * @param coefficients 系数数组
+ * @param exponents 指数数组
+ * @param capacity 数组可以容纳的项数
+ * @param stride 相邻两项在数组中的间隔
+ * @param count 输出: 项数
+ * @return 0: success, other: error code
+ */
+int calculate_polynomial_terms(const char* expression, int64_t* coefficients, int64_t* exponents, long long capacity,
+                               int stride, long long* count) {
+    int ret = check_terms_output(coefficients, exponents, capacity, stride, count);
+    if (ret != ERROR_SUCCESS) {
+        return ret;
+    }
+
+    if (!expression) {
+        return ERROR_EMPTY_EXPRESSION;
+    }
+
+    string expr_str;
+    ret = prepare_named_expression(expression, expr_str);
+    if (ret != ERROR_SUCCESS) {
+        return ret;
+    }
+
+    size_t term_count = 0;
+    ret = expression_error(active_polynomial_engine().calculate_polynomial_terms(
+        expr_str, coefficients, exponents, static_cast<size_t>(capacity), static_cast<size_t>(stride), term_count));
+    *count = static_cast<long long>(term_count);
+    return ret;
+}
+
+/**
+ * @brief 创建独立的多项式工作区: 拥有自己的多项式表、锁和结果缓存, 与其他工作区和默认工作区互不影响
+ *        不同线程可以各用一个工作区并行计算; 句柄在 destroy_polynomial_workspace 之前有效
+ * @param kind 系数类型, 取值同 set_polynomial_coefficient_type, 之后不能更改
+ * @return 工作区句柄, 类型不存在或当前编译器不支持时返回 NULL
+ */
+PolynomialEngine* create_polynomial_workspace(int kind) {
+    return create_polynomial_engine(kind);
+}
+
+/**
+ * @brief 释放工作区及其中的多项式, 调用方须保证没有其他线程正在使用该句柄
+ * @param workspace create_polynomial_workspace 返回的句柄
+ * @return 0: success, ERROR_INVALID_INPUT: 句柄为空
+ */
+int destroy_polynomial_workspace(PolynomialEngine* workspace) {
+    if (!workspace) {
+        return ERROR_INVALID_INPUT;
+    }
+    delete workspace;
+    return ERROR_SUCCESS;
+}
+
+// 以下为原有接口的工作区版本: 第一个参数为工作区句柄, 其余参数、返回值与同名接口相同;
+// 句柄为空时返回 ERROR_INVALID_INPUT. 编译后的表达式句柄在所有工作区之间共用
+
+int workspace_create_polynomial(PolynomialEngine* workspace, char name, const char* input) {
+    if (!workspace) {
+        return ERROR_INVALID_INPUT;
+    }
+    ScopedPolynomialEngine scope(workspace);
+    return create_polynomial(name, input);
+}
+
+int workspace_create_named_polynomial(PolynomialEngine* workspace, const char* name, const char* input) {
+    if (!workspace) {
+        return ERROR_INVALID_INPUT;
+    }
+    ScopedPolynomialEngine scope(workspace);
+    return create_named_polynomial(name, input);
+}
+
+int workspace_load_named_polynomial(PolynomialEngine* workspace, const char* name, const char* input, long long* error_offset) {
+    if (!workspace) {
+        return ERROR_INVALID_INPUT;
+    }
+    ScopedPolynomialEngine scope(workspace);
+    return load_named_polynomial(name, input, error_offset);
+}
+
+int workspace_create_polynomial_from_terms(PolynomialEngine* workspace, const char* name, const int64_t* coefficients,
+                                           const int64_t* exponents, long long count, int stride, int flags,
+                                           long long* error_index) {
+    if (!workspace) {
+        return ERROR_INVALID_INPUT;
+    }
+    ScopedPolynomialEngine scope(workspace);
+    return create_polynomial_from_terms(name, coefficients, exponents, count, stride, flags, error_index);
+}
+
+int workspace_write_polynomial_string(PolynomialEngine* workspace, const char* name, int format, char* output,
+                                      long long buffer_size, long long* length) {
+    if (!workspace) {
+        return ERROR_INVALID_INPUT;
+    }
+    ScopedPolynomialEngine scope(workspace);
+    return write_polynomial_string(name, format, output, buffer_size, length);
+}
+
+int workspace_write_calculation_result(PolynomialEngine* workspace, const char* expression, int format, char* output,
+                                       long long buffer_size, long long* length) {
+    if (!workspace) {
+        return ERROR_INVALID_INPUT;
+    }
+    ScopedPolynomialEngine scope(workspace);
+    return write_calculation_result(expression, format, output, buffer_size, length);
+}
+
+int workspace_write_derivative_result(PolynomialEngine* workspace, char name, int format, char* output,
+                                      long long buffer_size, long long* length) {
+    if (!workspace) {
+        return ERROR_INVALID_INPUT;
+    }
+    ScopedPolynomialEngine scope(workspace);
+    return write_derivative_result(name, format, output, buffer_size, length);
+}
+
+int workspace_get_polynomial_terms(PolynomialEngine* workspace, const char* name, int64_t* coefficients,
+                                   int64_t* exponents, long long capacity, int stride, long long* count) {
+    if (!workspace) {
+        return ERROR_INVALID_INPUT;
+    }
+    ScopedPolynomialEngine scope(workspace);
+    return get_polynomial_terms(name, coefficients, exponents, capacity, stride, count);
+}
+
+int workspace_calculate_polynomial_terms(PolynomialEngine* workspace, const char* expression, int64_t* coefficients,
+                                         int64_t* exponents, long long capacity, int stride, long long* count) {
+    if (!workspace) {
+        return ERROR_INVALID_INPUT;
+    }
+    ScopedPolynomialEngine scope(workspace);
+    return calculate_polynomial_terms(expression, coefficients, exponents, capacity, stride, count);
+}
+
+int workspace_get_polynomial_to_string(PolynomialEngine* workspace, char name, char* output, int buffer_size) {
+    if (!workspace) {
+        return ERROR_INVALID_INPUT;
+    }
+    ScopedPolynomialEngine scope(workspace);
+    return get_polynomial_to_string(name, output, buffer_size);
+}
+
+int workspace_get_named_polynomial_to_string(PolynomialEngine* workspace, const char* name, char* output,
+                                             int buffer_size) {
+    if (!workspace) {
+        return ERROR_INVALID_INPUT;
+    }
+    ScopedPolynomialEngine scope(workspace);
+    return get_named_polynomial_to_string(name, output, buffer_size);
+}
+
+int workspace_calculate_polynomials(PolynomialEngine* workspace, const char* expression, char* output,
+                                    int buffer_size) {
+    if (!workspace) {
+        return ERROR_INVALID_INPUT;
+    }
+    ScopedPolynomialEngine scope(workspace);
+    return calculate_polynomials(expression, output, buffer_size);
+}
+
+int workspace_calculate_named_expression(PolynomialEngine* workspace, const char* expression, char* output,
+                                         int buffer_size) {
+    if (!workspace) {
+        return ERROR_INVALID_INPUT;
+    }
+    ScopedPolynomialEngine scope(workspace);
+    return calculate_named_expression(expression, output, buffer_size);
+}
+
+int workspace_explain_polynomial_expression(PolynomialEngine* workspace, const char* expression, char* output,
+                                            int buffer_size) {
+    if (!workspace) {
+        return ERROR_INVALID_INPUT;
+    }
+    ScopedPolynomialEngine scope(workspace);
+    return explain_polynomial_expression(expression, output, buffer_size);
+}
+
+int workspace_calculate_compiled_expression(PolynomialEngine* workspace, int handle, char* output, int buffer_size) {
+    if (!workspace) {
+        return ERROR_INVALID_INPUT;
+    }
+    ScopedPolynomialEngine scope(workspace);
+    return calculate_compiled_expression(handle, output, buffer_size);
+}
+
+int workspace_calculate_compiled_expression_with_latex(PolynomialEngine* workspace, int handle, char* output,
+                                                       int buffer_size) {
+    if (!workspace) {
+        return ERROR_INVALID_INPUT;
+    }
+    ScopedPolynomialEngine scope(workspace);
+    return calculate_compiled_expression_with_latex(handle, output, buffer_size);
+}
+
+int workspace_evaluate_polynomial(PolynomialEngine* workspace, char name, int x, int* result) {
+    if (!workspace) {
+        return ERROR_INVALID_INPUT;
+    }
+    ScopedPolynomialEngine scope(workspace);
+    return evaluate_polynomial(name, x, result);
+}
+
+int workspace_evaluate_polynomial_batch(PolynomialEngine* workspace, char name, const int* xs, int count,
+                                        int* results) {
+    if (!workspace) {
+        return ERROR_INVALID_INPUT;
+    }
+    ScopedPolynomialEngine scope(workspace);
+    return evaluate_polynomial_batch(name, xs, count, results);
+}
+
+int workspace_derivative_polynomial(PolynomialEngine* workspace, char name, char* output, int buffer_size) {
+    if (!workspace) {
+        return ERROR_INVALID_INPUT;
+    }
+    ScopedPolynomialEngine scope(workspace);
+    return derivative_polynomial(name, output, buffer_size);
+}
+
+int workspace_evaluate_polynomial_to_string(PolynomialEngine* workspace, char name, int x, char* output,
+                                            int buffer_size) {
+    if (!workspace) {
+        return ERROR_INVALID_INPUT;
+    }
+    ScopedPolynomialEngine scope(workspace);
+    return evaluate_polynomial_to_string(name, x, output, buffer_size);
+}
+
+int workspace_clear_all_polynomials(PolynomialEngine* workspace) {
+    if (!workspace) {
+        return ERROR_INVALID_INPUT;
+    }
+    ScopedPolynomialEngine scope(workspace);
+    return clear_all_polynomials();
+}
+
+int workspace_set_polynomial_cache_budget(PolynomialEngine* workspace, long long bytes) {
+    if (!workspace) {
+        return ERROR_INVALID_INPUT;
+    }
+    ScopedPolynomialEngine scope(workspace);
+    return set_polynomial_cache_budget(bytes);
+}
+
+int workspace_get_polynomial_cache_stats(PolynomialEngine* workspace, long long* hits, long long* misses,
+                                         long long* entries, long long* bytes) {
+    if (!workspace) {
+        return ERROR_INVALID_INPUT;
+    }
+    ScopedPolynomialEngine scope(workspace);
+    return get_polynomial_cache_stats(hits, misses, entries, bytes);
+}
+
+int workspace_get_polynomial_names(PolynomialEngine* workspace, char* names, int max_count) {
+    if (!workspace) {
+        return ERROR_INVALID_INPUT;
+    }
+    ScopedPolynomialEngine scope(workspace);
+    return get_polynomial_names(names, max_count);
+}
+
+int workspace_polynomial_exists(PolynomialEngine* workspace, char name) {
+    if (!workspace) {
+        return ERROR_INVALID_INPUT;
+    }
+    ScopedPolynomialEngine scope(workspace);
+    return polynomial_exists(name);
+}
+
+int workspace_get_polynomial_term_count(PolynomialEngine* workspace, char name, int* count) {
+    if (!workspace) {
+        return ERROR_INVALID_INPUT;
+    }
+    ScopedPolynomialEngine scope(workspace);
+    return get_polynomial_term_count(name, count);
+}
+
+// 工作区保存的多项式个数; workspace 为 NULL 时返回负数 ERROR_INVALID_INPUT, 个数本身不会为负
+long long workspace_get_polynomial_count(PolynomialEngine* workspace) {
+    if (!workspace) {
+        return ERROR_INVALID_INPUT;
+    }
+    ScopedPolynomialEngine scope(workspace);
+    return get_polynomial_count();
+}
+
 // 错误信息
 const char* get_polynomial_error_description(int error_code) {
     switch (error_code) {
         case ERROR_SUCCESS:
             return "Success";
         case ERROR_INVALID_NAME:
-            return "多项式名称错误(must be 'a'-'e')";
+            return "多项式名称错误 (字母或下划线开头, 之后为字母、数字或下划线)";
         case ERROR_POLYNOMIAL_NOT_FOUND:
             return "多项式不存在";
         case ERROR_INVALID_INPUT:
             return "非法输入";
-        case ERROR_TOO_MANY_POLYNOMIALS:
-            return "数量超过上限 (maximum 5)";
+        case ERROR_RESERVED:
+            return "保留的错误码";
         case ERROR_EMPTY_EXPRESSION:
             return "多项式为空";
         case ERROR_EXPRESSION_PARSE_ERROR:
@@ -298,6 +1194,8 @@ const char* get_polynomial_error_description(int error_code) {
             return "括号不匹配";
         case ERROR_INVALID_CHARACTER:
             return "非法字符";
+        case ERROR_MALFORMED_INPUT:
+            return "输入格式错误";
         default:
             return "未知错误";
     }
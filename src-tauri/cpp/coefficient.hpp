@@ -0,0 +1,251 @@
+#pragma once
+
+#include <charconv>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "bigint.hpp"
+
+using namespace std;
+
+// 编译器提供 128 位整数时启用 __int128 系数 (GCC / Clang), MSVC 下不可用
+#if defined(__SIZEOF_INT128__)
+#define POLYNOMIAL_HAS_INT128 1
+#else
+#define POLYNOMIAL_HAS_INT128 0
+#endif
+
+// ModInt类: 模素数 MOD 的剩余类, 值始终规范在 [0, MOD) 内
+template <uint32_t MOD>
+class ModInt {
+private:
+    uint32_t value_;
+
+public:
+
+    ModInt() : value_(0) {}
+
+    ModInt(long long value) {
+        long long r = value % static_cast<long long>(MOD);
+        value_ = static_cast<uint32_t>(r < 0 ? r + MOD : r);
+    }
+
+    // 由已规范的剩余构造
+    static ModInt from_residue(uint32_t residue) {
+        ModInt result;
+        result.value_ = residue;
+        return result;
+    }
+
+    static uint32_t modulus() { return MOD; }
+
+    uint32_t value() const { return value_; }
+
+    ModInt operator-() const { return from_residue(value_ == 0 ? 0 : MOD - value_); }
+
+    ModInt& operator+=(const ModInt& other) {
+        value_ += other.value_;
+        if (value_ >= MOD) {
+            value_ -= MOD;
+        }
+        return *this;
+    }
+
+    ModInt& operator-=(const ModInt& other) {
+        value_ = value_ >= other.value_ ? value_ - other.value_ : value_ + MOD - other.value_;
+        return *this;
+    }
+
+    ModInt& operator*=(const ModInt& other) {
+        value_ = static_cast<uint32_t>(static_cast<uint64_t>(value_) * other.value_ % MOD);
+        return *this;
+    }
+
+    friend ModInt operator+(ModInt lhs, const ModInt& rhs) { return lhs += rhs; }
+    friend ModInt operator-(ModInt lhs, const ModInt& rhs) { return lhs -= rhs; }
+    friend ModInt operator*(ModInt lhs, const ModInt& rhs) { return lhs *= rhs; }
+    friend bool operator==(const ModInt& lhs, const ModInt& rhs) { return lhs.value_ == rhs.value_; }
+    friend bool operator!=(const ModInt& lhs, const ModInt& rhs) { return lhs.value_ != rhs.value_; }
+};
+
+// 默认的模素数系数类型 (998244353 = 119 * 2^23 + 1)
+using Zp = ModInt<998244353>;
+
+// 用 from_chars 解析十进制整数 (可带正负号), 必须用完整个 text, 溢出时失败
+template <typename T>
+inline bool parse_integer(string_view text, T& value) {
+    if (!text.empty() && text[0] == '+') {
+        text.remove_prefix(1);
+        if (!text.empty() && text[0] == '-') {
+            return false;
+        }
+    }
+    const char* last = text.data() + text.size();
+    from_chars_result result = from_chars(text.data(), last, value);
+    return result.ec == errc() && result.ptr == last;
+}
+
+// 定宽有符号整数的环运算: 经同宽度的无符号数计算, 溢出按补码回绕 (有符号溢出是未定义行为)
+template <typename S, typename U>
+struct wrapping_arithmetic {
+    static S add(S a, S b) { return static_cast<S>(static_cast<U>(a) + static_cast<U>(b)); }
+    static S sub(S a, S b) { return static_cast<S>(static_cast<U>(a) - static_cast<U>(b)); }
+    static S mul(S a, S b) { return static_cast<S>(static_cast<U>(a) * static_cast<U>(b)); }
+    static S negate(S a) { return static_cast<S>(U(0) - static_cast<U>(a)); }
+    static void add_to(S& acc, S value) { acc = add(acc, value); }
+    static void subtract_from(S& acc, S value) { acc = sub(acc, value); }
+};
+
+// 其他系数类型的环运算直接使用运算符 (模素数不会溢出, 任意精度不截断); 原地版本避免临时对象
+template <typename C>
+struct operator_arithmetic {
+    static C add(const C& a, const C& b) { return a + b; }
+    static C sub(const C& a, const C& b) { return a - b; }
+    static C mul(const C& a, const C& b) { return a * b; }
+    static C negate(const C& a) { return -a; }
+    static void add_to(C& acc, const C& value) { acc += value; }
+    static void subtract_from(C& acc, const C& value) { acc -= value; }
+};
+
+// coefficient_traits: 多项式系数 / 指数类型需要的类型相关操作
+//  machine_word: 可以按补码放进 uint64_t 使用 2^64 剩余类乘法内核 (结果截断后与直接相乘一致)
+//  low_32_bits:  只需要乘积的低 32 位, 允许使用损失高位的 Toom-3
+//  to_string / parse: 十进制文本转换, parse 要求整个 text 为一个整数 (不含空白), 失败返回 false
+//  is_negative: 输出符号 (模素数类型按 [0, MOD) 输出, 不为负)
+//  from_int64 / to_int64: 与 64 位整数互相转换, to_int64 超出范围时截断
+//  add / sub / mul / negate / add_to / subtract_from: 系数的环运算, 定宽整数按补码回绕
+template <typename C>
+struct coefficient_traits;
+
+template <>
+struct coefficient_traits<int> : wrapping_arithmetic<int, uint32_t> {
+    static constexpr bool machine_word = true;
+    static constexpr bool low_32_bits = true;
+
+    static string to_string(int value) { return std::to_string(value); }
+
+    static bool parse(string_view text, int& value) { return parse_integer(text, value); }
+
+    static bool is_negative(int value) { return value < 0; }
+    static int from_int64(int64_t value) { return static_cast<int>(value); }
+    static int64_t to_int64(int value) { return value; }
+};
+
+template <>
+struct coefficient_traits<int64_t> : wrapping_arithmetic<int64_t, uint64_t> {
+    static constexpr bool machine_word = true;
+    static constexpr bool low_32_bits = false;
+
+    static string to_string(int64_t value) { return std::to_string(value); }
+
+    static bool parse(string_view text, int64_t& value) { return parse_integer(text, value); }
+
+    static bool is_negative(int64_t value) { return value < 0; }
+    static int64_t from_int64(int64_t value) { return value; }
+    static int64_t to_int64(int64_t value) { return value; }
+};
+
+#if POLYNOMIAL_HAS_INT128
+template <>
+struct coefficient_traits<__int128> : wrapping_arithmetic<__int128, unsigned __int128> {
+    static constexpr bool machine_word = false;
+    static constexpr bool low_32_bits = false;
+
+    static string to_string(__int128 value) {
+        unsigned __int128 magnitude = value < 0 ? 0 - static_cast<unsigned __int128>(value)
+                                                : static_cast<unsigned __int128>(value);
+        string digits;
+        do {
+            digits += static_cast<char>('0' + static_cast<int>(magnitude % 10));
+            magnitude /= 10;
+        } while (magnitude != 0);
+        if (value < 0) {
+            digits += '-';
+        }
+        return string(digits.rbegin(), digits.rend());
+    }
+
+    static bool parse(string_view text, __int128& value) {
+        size_t pos = 0;
+        bool negative = false;
+        if (pos < text.size() && (text[pos] == '+' || text[pos] == '-')) {
+            negative = text[pos] == '-';
+            ++pos;
+        }
+        if (pos >= text.size()) {
+            return false;
+        }
+        // 绝对值上限: 正数 2^127 - 1, 负数 2^127
+        const unsigned __int128 limit = (static_cast<unsigned __int128>(1) << 127) - (negative ? 0 : 1);
+        unsigned __int128 magnitude = 0;
+        for (; pos < text.size(); ++pos) {
+            char c = text[pos];
+            if (c < '0' || c > '9') {
+                return false;
+            }
+            unsigned digit = static_cast<unsigned>(c - '0');
+            if (magnitude > (limit - digit) / 10) {
+                return false;
+            }
+            magnitude = magnitude * 10 + digit;
+        }
+        value = static_cast<__int128>(negative ? 0 - magnitude : magnitude);
+        return true;
+    }
+
+    static bool is_negative(__int128 value) { return value < 0; }
+    static __int128 from_int64(int64_t value) { return value; }
+    static int64_t to_int64(__int128 value) { return static_cast<int64_t>(value); }
+};
+#endif
+
+template <uint32_t MOD>
+struct coefficient_traits<ModInt<MOD>> : operator_arithmetic<ModInt<MOD>> {
+    static constexpr bool machine_word = false;
+    static constexpr bool low_32_bits = false;
+
+    static string to_string(const ModInt<MOD>& value) { return std::to_string(value.value()); }
+
+    // 十进制整数按 MOD 取余, 不限长度
+    static bool parse(string_view text, ModInt<MOD>& value) {
+        size_t pos = 0;
+        bool negative = false;
+        if (pos < text.size() && (text[pos] == '+' || text[pos] == '-')) {
+            negative = text[pos] == '-';
+            ++pos;
+        }
+        if (pos >= text.size()) {
+            return false;
+        }
+        uint64_t residue = 0;
+        for (; pos < text.size(); ++pos) {
+            char c = text[pos];
+            if (c < '0' || c > '9') {
+                return false;
+            }
+            residue = (residue * 10 + static_cast<uint64_t>(c - '0')) % MOD;
+        }
+        value = ModInt<MOD>::from_residue(static_cast<uint32_t>(residue));
+        if (negative) {
+            value = -value;
+        }
+        return true;
+    }
+
+    static bool is_negative(const ModInt<MOD>&) { return false; }
+    static ModInt<MOD> from_int64(int64_t value) { return ModInt<MOD>(static_cast<long long>(value)); }
+    static int64_t to_int64(const ModInt<MOD>& value) { return value.value(); }
+};
+
+template <>
+struct coefficient_traits<BigInt> : operator_arithmetic<BigInt> {
+    static constexpr bool machine_word = false;
+    static constexpr bool low_32_bits = false;
+
+    static string to_string(const BigInt& value) { return value.to_string(); }
+    static bool parse(string_view text, BigInt& value) { return BigInt::parse(text, value); }
+    static bool is_negative(const BigInt& value) { return value.is_negative(); }
+    static BigInt from_int64(int64_t value) { return BigInt(static_cast<long long>(value)); }
+    static int64_t to_int64(const BigInt& value) { return value.low_int64(); }
+};
@@ -0,0 +1,383 @@
+#include "expression_plan.hpp"
+#include "name_table.hpp"
+#include "poly_multiply.hpp"
+#include "stack.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+// ============================================================================
+// ExpressionPlan类实现
+// ============================================================================
+
+// 节点的哈希值, key 为 LOAD 节点名称的哈希值, 其他节点为 0
+static size_t hash_node(char op, size_t key, int lhs, int rhs) {
+    size_t h = static_cast<unsigned char>(op) * 31u + key;
+    h = h * 0x9E3779B1u + static_cast<unsigned>(lhs);
+    h = h * 0x9E3779B1u + static_cast<unsigned>(rhs);
+    return h ^ (h >> 15);
+}
+
+size_t ExpressionPlan::node_hash(const Node& node) const {
+    size_t key = node.op == LOAD ? hash<string_view>()(identifiers_[node.name]) : 0;
+    return hash_node(node.op, key, node.lhs, node.rhs);
+}
+
+// 表的负载不超过 1/2, 满时翻倍重建
+void ExpressionPlan::reserve_table() {
+    if (2 * (nodes_.size() + 1) <= table_.size()) {
+        return;
+    }
+    table_.assign(table_.empty() ? 16 : table_.size() * 2, -1);
+    for (size_t k = 0; k < nodes_.size(); ++k) {
+        size_t slot = node_hash(nodes_[k]) & (table_.size() - 1);
+        while (table_[slot] >= 0) {
+            slot = (slot + 1) & (table_.size() - 1);
+        }
+        table_[slot] = static_cast<int>(k);
+    }
+}
+
+// 哈希查找相同的节点
+int ExpressionPlan::intern(char op, int lhs, int rhs) {
+    reserve_table();
+
+    size_t slot = hash_node(op, 0, lhs, rhs) & (table_.size() - 1);
+    while (table_[slot] >= 0) {
+        const Node& node = nodes_[table_[slot]];
+        if (node.op == op && node.lhs == lhs && node.rhs == rhs) {
+            return table_[slot];
+        }
+        slot = (slot + 1) & (table_.size() - 1);
+    }
+
+    int index = static_cast<int>(nodes_.size());
+    nodes_.push_back({op, -1, lhs, rhs, 0, 0, 0});
+    table_[slot] = index;
+    return index;
+}
+
+// 同名的多项式只读取一次
+int ExpressionPlan::intern_load(string_view identifier) {
+    reserve_table();
+
+    size_t slot = hash_node(LOAD, hash<string_view>()(identifier), -1, -1) & (table_.size() - 1);
+    while (table_[slot] >= 0) {
+        const Node& node = nodes_[table_[slot]];
+        if (node.op == LOAD && identifiers_[node.name] == identifier) {
+            return table_[slot];
+        }
+        slot = (slot + 1) & (table_.size() - 1);
+    }
+
+    int index = static_cast<int>(nodes_.size());
+    identifiers_.emplace_back(identifier);
+    nodes_.push_back({LOAD, static_cast<int>(identifiers_.size()) - 1, -1, -1, 0, 0, 0});
+    table_[slot] = index;
+    return index;
+}
+
+// 加法和乘法满足交换律, 操作数按下标排序后再查找, 使 a+b 与 b+a 合并; x * x 记为平方
+int ExpressionPlan::emit_operator(char op) {
+    if (operands_.size() < 2 || op == '(') {
+        return -6; // 操作数不足, 或有未匹配的 '('
+    }
+    int rhs = operands_.back();
+    operands_.pop_back();
+    int lhs = operands_.back();
+
+    if ((op == '+' || op == '*') && rhs < lhs) {
+        swap(lhs, rhs);
+    }
+    if (op == '*' && lhs == rhs) {
+        operands_.back() = intern(SQUARE, lhs, -1);
+    } else {
+        operands_.back() = intern(op, lhs, rhs);
+    }
+    return 0;
+}
+
+// 调度场算法建图, 运算符优先级和出错时机与逐字符求值一致
+int ExpressionPlan::compile(const string& expr) {
+    nodes_.clear();
+    chain_operands_.clear();
+    identifiers_.clear();
+    fill(table_.begin(), table_.end(), -1);
+    operands_.clear();
+    source_ = expr;
+    root_ = -1;
+
+    if (expr.empty()) {
+        return -4; // 空表达式
+    }
+
+    Stack<char> op_stack;
+
+    for (size_t i = 0; i < expr.length(); ++i) {
+        char c = expr[i];
+
+        if (NameTable::is_identifier_start(c)) {
+            // 名称取最长的标识符, 单个字母 a - e 与原来的写法一致
+            size_t end = i + 1;
+            while (end < expr.length() && NameTable::is_identifier_char(expr[end])) {
+                ++end;
+            }
+            operands_.push_back(intern_load(string_view(expr).substr(i, end - i)));
+            i = end - 1;
+        } else if (c == '+' || c == '-' || c == '*') {
+            while (!op_stack.empty() && op_stack.top() != '(' &&
+                   ((op_stack.top() == '*') || (op_stack.top() != '*' && c != '*'))) {
+                int status = emit_operator(op_stack.pop());
+                if (status != 0) {
+                    return status;
+                }
+            }
+            op_stack.push(c);
+        } else if (c == '(') {
+            op_stack.push(c);
+        } else if (c == ')') {
+            while (!op_stack.empty() && op_stack.top() != '(') {
+                int status = emit_operator(op_stack.pop());
+                if (status != 0) {
+                    return status;
+                }
+            }
+            if (op_stack.empty()) {
+                return -7; // 括号不匹配
+            }
+            op_stack.pop();
+        } else if (c != ' ' && c != '\t') {
+            return -8; // 非法字符
+        }
+    }
+
+    while (!op_stack.empty()) {
+        int status = emit_operator(op_stack.pop());
+        if (status != 0) {
+            return status;
+        }
+    }
+
+    if (operands_.size() != 1) {
+        return -6; // Expression error
+    }
+
+    // 统计引用次数, 执行时据此判断中间结果何时可以原地修改
+    root_ = operands_.back();
+    for (Node& node : nodes_) {
+        node.uses = 0;
+    }
+    for (const Node& node : nodes_) {
+        if (node.lhs >= 0) {
+            ++nodes_[node.lhs].uses;
+        }
+        if (node.rhs >= 0) {
+            ++nodes_[node.rhs].uses;
+        }
+    }
+    ++nodes_[root_].uses;
+    build_chains();
+    return 0;
+}
+
+// 子节点属于同种链 (乘积链为 *, 求和链为 + / -) 且只被本链引用时展开, 否则作为链的一个操作数;
+// 操作数保持从左到右的顺序. 用 operands_ 作显式栈, 很长的链也不会递归过深;
+// 栈中负数 ~k 表示节点 k 在求和中取负 ('-' 的右侧, 再经过一次 '-' 时恢复为正)
+void ExpressionPlan::collect_chain(int index, bool product) {
+    operands_.assign(1, index);
+    while (!operands_.empty()) {
+        int entry = operands_.back();
+        operands_.pop_back();
+        int k = entry >= 0 ? entry : ~entry;
+        int sign = entry >= 0 ? 1 : -1;
+        Node& node = nodes_[k];
+        bool same = product ? node.op == '*' : (node.op == '+' || node.op == '-');
+        if (k == index || (same && node.uses == 1)) {
+            if (k != index) {
+                node.uses = 0;
+            }
+            int rhs_sign = node.op == '-' ? -sign : sign;
+            operands_.push_back(rhs_sign > 0 ? node.rhs : ~node.rhs);
+            operands_.push_back(sign > 0 ? node.lhs : ~node.lhs);
+        } else {
+            chain_operands_.push_back({k, sign});
+        }
+    }
+}
+
+// 从根开始逆拓扑序处理, 父节点先于子节点, 已并入的子节点 uses 为 0 而被跳过
+void ExpressionPlan::build_chains() {
+    for (int k = static_cast<int>(nodes_.size()) - 1; k >= 0; --k) {
+        Node& node = nodes_[k];
+        if ((node.op != '+' && node.op != '-' && node.op != '*') || node.uses == 0) {
+            continue;
+        }
+        int first = static_cast<int>(chain_operands_.size());
+        collect_chain(k, node.op == '*');
+        int count = static_cast<int>(chain_operands_.size()) - first;
+        if (count > 2) {
+            nodes_[k].op = node.op == '*' ? '*' : '+';
+            nodes_[k].first = first;
+            nodes_[k].count = count;
+        } else {
+            chain_operands_.resize(first);
+        }
+    }
+}
+
+// 乘法: 稀疏时约为两侧项数之积; 两侧都接近稠密时按分块 Karatsuba 估计
+// 加法: 归并两侧的项
+double ExpressionPlan::estimate(char op, const OperandStats& lhs, const OperandStats& rhs, OperandStats& result) {
+    if (lhs.terms == 0 || rhs.terms == 0) {
+        result = op == '*' ? OperandStats{0, 0, 0} : (lhs.terms == 0 ? rhs : lhs);
+        return lhs.terms + rhs.terms;
+    }
+
+    // 结果的项数不超过两者的组合数, 也不超过指数范围的长度
+    double lhs_span = static_cast<double>(lhs.high - lhs.low) + 1;
+    double rhs_span = static_cast<double>(rhs.high - rhs.low) + 1;
+    if (op == '*') {
+        result.low = lhs.low + rhs.low;
+        result.high = lhs.high + rhs.high;
+        result.terms = min(lhs.terms * rhs.terms, lhs_span + rhs_span - 1);
+
+        double cost = lhs.terms * rhs.terms;
+        if (2 * lhs.terms >= lhs_span && 2 * rhs.terms >= rhs_span) {
+            double shorter = min(lhs_span, rhs_span);
+            double longer = max(lhs_span, rhs_span);
+            double block = shorter <= poly_kernels::KARATSUBA_THRESHOLD ? shorter * shorter : pow(shorter, 1.585);
+            cost = min(cost, longer / shorter * block);
+        }
+        return cost + result.terms;
+    }
+
+    result.low = min(lhs.low, rhs.low);
+    result.high = max(lhs.high, rhs.high);
+    result.terms = min(lhs.terms + rhs.terms, static_cast<double>(result.high - result.low) + 1);
+    return lhs.terms + rhs.terms;
+}
+
+// 按子集动态规划得到的最优结合方式, 后序写出合并步骤, 返回子集中最小的操作数下标
+static int emit_merges(unsigned set, const unsigned* split, vector<pair<int, int>>& merges) {
+    unsigned left = split[set];
+    if (left == 0) {
+        int index = 0;
+        while (!(set & (1u << index))) {
+            ++index;
+        }
+        return index;
+    }
+    int lhs = emit_merges(left, split, merges);
+    int rhs = emit_merges(set & ~left, split, merges);
+    merges.emplace_back(lhs, rhs);
+    return lhs;
+}
+
+double ExpressionPlan::order_chain(char op, const OperandStats* stats, size_t count, vector<pair<int, int>>& merges) {
+    merges.clear();
+
+    if (op == '*' && count <= MAX_EXACT_CHAIN) {
+        // set 为操作数下标的位集合; 子集的规模估计与结合方式无关, 由去掉最低位后的子集加上该操作数得到
+        const unsigned full = (1u << count) - 1;
+        OperandStats set_stats[1u << MAX_EXACT_CHAIN];
+        double best[1u << MAX_EXACT_CHAIN];
+        unsigned split[1u << MAX_EXACT_CHAIN];
+
+        for (unsigned set = 1; set <= full; ++set) {
+            unsigned low = set & (~set + 1);
+            unsigned rest = set ^ low;
+            int index = 0;
+            while ((1u << index) != low) {
+                ++index;
+            }
+            split[set] = 0;
+            best[set] = 0;
+            if (rest == 0) {
+                set_stats[set] = stats[index];
+                continue;
+            }
+            estimate(op, set_stats[rest], stats[index], set_stats[set]);
+
+            // 枚举包含最低位的真子集作为左半部分, 避免重复计算对称的划分
+            best[set] = -1;
+            for (unsigned part = rest; ; part = (part - 1) & rest) {
+                unsigned left = part | low;
+                if (left != set) {
+                    OperandStats merged;
+                    double cost = best[left] + best[set ^ left] + estimate(op, set_stats[left], set_stats[set ^ left], merged);
+                    if (best[set] < 0 || cost < best[set]) {
+                        best[set] = cost;
+                        split[set] = left;
+                    }
+                }
+                if (part == 0) {
+                    break;
+                }
+            }
+        }
+
+        emit_merges(full, split, merges);
+        return best[full];
+    }
+
+    // 加法和长的乘法链: 每次合并估计项数最少的两个 (对加法即 Huffman 合并, 总代价最小), 结果放在下标较小的位置
+    typedef pair<double, int> Entry;
+    static thread_local vector<Entry> heap;  // 复用内存
+    static thread_local vector<OperandStats> current;
+    heap.clear();
+    current.assign(stats, stats + count);
+    for (size_t i = 0; i < count; ++i) {
+        heap.emplace_back(stats[i].terms, static_cast<int>(i));
+    }
+    auto later = [](const Entry& x, const Entry& y) { return x > y; };
+    make_heap(heap.begin(), heap.end(), later);
+
+    double total = 0;
+    while (heap.size() > 1) {
+        pop_heap(heap.begin(), heap.end(), later);
+        int a = heap.back().second;
+        heap.pop_back();
+        pop_heap(heap.begin(), heap.end(), later);
+        int b = heap.back().second;
+        heap.pop_back();
+
+        int lhs = min(a, b);
+        int rhs = max(a, b);
+        OperandStats merged;
+        total += estimate(op, current[lhs], current[rhs], merged);
+        current[lhs] = merged;
+        merges.emplace_back(lhs, rhs);
+        heap.emplace_back(merged.terms, lhs);
+        push_heap(heap.begin(), heap.end(), later);
+    }
+    return total;
+}
+
+// ============================================================================
+// ExpressionPlanRegistry类实现
+// ============================================================================
+
+ExpressionPlanRegistry& ExpressionPlanRegistry::instance() {
+    static ExpressionPlanRegistry registry;
+    return registry;
+}
+
+int ExpressionPlanRegistry::add(shared_ptr<const ExpressionPlan> plan) {
+    lock_guard<mutex> lock(mutex_);
+    int handle = next_handle_++;
+    plans_[handle] = std::move(plan);
+    return handle;
+}
+
+shared_ptr<const ExpressionPlan> ExpressionPlanRegistry::find(int handle) const {
+    lock_guard<mutex> lock(mutex_);
+    auto it = plans_.find(handle);
+    return it == plans_.end() ? nullptr : it->second;
+}
+
+bool ExpressionPlanRegistry::remove(int handle) {
+    lock_guard<mutex> lock(mutex_);
+    return plans_.erase(handle) > 0;
+}
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// 多项式的规模统计, 供规划器估计运算代价
+struct OperandStats {
+    double terms;    // 非零项数
+    long long low;   // 最低次数
+    long long high;  // 最高次数
+};
+
+// 编译后的多项式表达式, 与系数类型无关
+// 词法和语法检查只在编译时做一次, 之后可以对当前绑定的多项式反复执行
+// 表达式保存为有向无环图: 相同的子表达式 (包括交换 + / * 两侧后相同的) 只保留一个节点,
+// 每次执行只计算一次; x * x 记为平方节点
+// 连续的 + / - 合并为一个多元求和节点, 一次归并所有操作数;
+// 连续的 * 合并为乘积链, 执行时按操作数的实际规模决定结合顺序
+class ExpressionPlan {
+public:
+    // 节点运算: LOAD 读取名称为 identifiers()[name] 的多项式, SQUARE 为 lhs 的平方, 其余为 '+' / '-' / '*'
+    static constexpr char LOAD = 'v';
+    static constexpr char SQUARE = '^';
+
+    // 链节点的一个操作数
+    struct ChainOperand {
+        int node;  // 节点下标
+        int sign;  // 求和链中的符号 (1 或 -1), 乘积链中总为 1
+    };
+
+    // 节点按拓扑序存放, 操作数的下标总是小于本节点
+    // 链节点 (count > 0) 的操作数为 chain_operands() 中 [first, first + count) 的节点, lhs / rhs 不再使用;
+    // 求和链的 op 为 '+' (由 '-' 节点展开的也是), 乘积链为 '*'
+    // 并入链节点的内部节点 uses 为 0, 执行时跳过
+    struct Node {
+        char op;
+        int name;    // op 为 LOAD 时为名称在 identifiers() 中的下标, 其他节点为 -1
+        int lhs;     // 操作数节点下标, LOAD 时为 -1
+        int rhs;     // 第二个操作数, LOAD / SQUARE 时为 -1
+        int uses;    // 被其他节点引用的次数, 根节点额外计 1 次
+        int first;   // 链节点操作数的起始位置
+        int count;   // 链节点操作数个数, 其他节点为 0
+    };
+
+    // 编译 expr, 覆盖之前的内容 (复用已申请的内存)
+    // 返回 0 成功, -4 空表达式, -6 表达式错误, -7 括号不匹配, -8 非法字符;
+    // 失败时 nodes() 保留出错位置之前已生成的节点
+    int compile(const std::string& expr);
+
+    const std::vector<Node>& nodes() const { return nodes_; }
+
+    const std::vector<ChainOperand>& chain_operands() const { return chain_operands_; }
+
+    // 表达式中出现的多项式名称 (标识符), 每个名称只出现一次, 按首次出现的顺序
+    const std::vector<std::string>& identifiers() const { return identifiers_; }
+
+    // 根节点下标 (编译成功时有效)
+    int root() const { return root_; }
+
+    // 编译时的表达式原文
+    const std::string& source() const { return source_; }
+
+    // 估计 lhs op rhs (op 为 '+' 或 '*') 的代价, 单位为逐项运算次数; 结果的规模估计写入 result
+    static double estimate(char op, const OperandStats& lhs, const OperandStats& rhs, OperandStats& result);
+
+    // 乘积链的 count 个操作数规模为 stats 时, 选择估计总代价最小的结合顺序, 返回估计总代价
+    // 结果按执行顺序写入 merges: 每项 (i, j) 表示把操作数 j 合并到操作数 i (i < j), 之后 j 不再使用
+    // 不超过 MAX_EXACT_CHAIN 个操作数时按子集动态规划求最优 (类似矩阵链, 但可任意交换次序);
+    // 更长的链每次合并估计项数最少的两个
+    static double order_chain(char op, const OperandStats* stats, size_t count, std::vector<std::pair<int, int>>& merges);
+
+    static const size_t MAX_EXACT_CHAIN = 8;
+
+private:
+    std::vector<Node> nodes_;
+    std::vector<ChainOperand> chain_operands_;
+    std::vector<std::string> identifiers_;
+    std::vector<int> table_;     // 开放寻址哈希表, 存节点下标, -1 为空; 用于合并相同的子表达式
+    std::vector<int> operands_;  // 编译时的操作数栈 (节点下标)
+    std::string source_;
+    int root_ = -1;
+
+    // 返回运算为 (op, lhs, rhs) 的节点, 已存在时复用
+    int intern(char op, int lhs, int rhs);
+
+    // 返回读取多项式 identifier 的节点, 已存在时复用
+    int intern_load(std::string_view identifier);
+
+    // 节点在 table_ 中的哈希值, LOAD 节点按名称计算
+    size_t node_hash(const Node& node) const;
+
+    // 为新节点预留位置: 负载超过 1/2 时翻倍重建
+    void reserve_table();
+
+    // 弹出两个操作数, 加入运算 op 的节点后压入
+    int emit_operator(char op);
+
+    // 把只被引用一次的同种子节点 (+ / - 或 *) 并入父节点, 三个以上操作数时改为链节点
+    void build_chains();
+
+    // 收集 index 节点所在链的操作数及符号
+    void collect_chain(int index, bool product);
+};
+
+// 编译后表达式的句柄表, 句柄为正整数, 所有系数类型共用
+class ExpressionPlanRegistry {
+public:
+    static ExpressionPlanRegistry& instance();
+
+    // 登记 plan, 返回新句柄
+    int add(std::shared_ptr<const ExpressionPlan> plan);
+
+    // 查找句柄, 不存在时返回空指针; 返回的计划在使用期间不会因 remove 而失效
+    std::shared_ptr<const ExpressionPlan> find(int handle) const;
+
+    // 释放句柄, 成功返回 true
+    bool remove(int handle);
+
+private:
+    ExpressionPlanRegistry() : next_handle_(1) {}
+
+    mutable std::mutex mutex_;
+    std::unordered_map<int, std::shared_ptr<const ExpressionPlan>> plans_;
+    int next_handle_;
+};
@@ -0,0 +1,179 @@
+#include "multipoint.hpp"
+#include "poly_multiply.hpp"
+
+#include <algorithm>
+
+using namespace std;
+
+namespace poly_multipoint {
+
+// 升序系数数组的 Horner 求值
+template <typename C>
+static C horner(const vector<C>& coeffs, const C& x) {
+    C result = C();
+    for (size_t i = coeffs.size(); i-- > 0;) {
+        result = coefficient_traits<C>::add(coefficient_traits<C>::mul(result, x), coeffs[i]);
+    }
+    return result;
+}
+
+// 截取前 n 项 (不足补零)
+template <typename C>
+static vector<C> truncated(const vector<C>& a, size_t n) {
+    vector<C> result(n, C());
+    copy(a.begin(), a.begin() + min(a.size(), n), result.begin());
+    return result;
+}
+
+// Newton 迭代: g <- g * (2 - h * g) mod x^(2k), 每轮精度翻倍
+template <typename C>
+vector<C> inverse_series(const vector<C>& h, size_t n) {
+    vector<C> g(1, C(1));
+    size_t len = 1;
+    while (len < n) {
+        len = min(2 * len, n);
+        vector<C> t = truncated(poly_kernels::convolve(truncated(h, len), g), len);
+        for (size_t i = 0; i < len; ++i) {
+            t[i] = coefficient_traits<C>::negate(t[i]);
+        }
+        coefficient_traits<C>::add_to(t[0], C(2));
+        g = truncated(poly_kernels::convolve(g, t), len);
+    }
+    return g;
+}
+
+// 取余: 商较短时朴素长除法; 否则 rev(q) = rev(a) * rev(b)^(-1) mod x^(n-m+1), r = a - q b
+template <typename C>
+vector<C> remainder(const vector<C>& a, const vector<C>& b) {
+    size_t m = b.size() - 1; // deg(b)
+    if (a.size() <= m) {
+        return truncated(a, m);
+    }
+    size_t k = a.size() - m; // 商的长度
+
+    if (k <= FAST_REMAINDER_THRESHOLD || m <= FAST_REMAINDER_THRESHOLD) {
+        vector<C> r = a;
+        for (size_t i = a.size() - 1; i >= m; --i) {
+            C q = r[i];
+            if (q != C()) {
+                C* dst = r.data() + (i - m);
+                for (size_t j = 0; j < m; ++j) {
+                    coefficient_traits<C>::subtract_from(dst[j], coefficient_traits<C>::mul(q, b[j]));
+                }
+            }
+            if (i == m) {
+                break;
+            }
+        }
+        r.resize(m);
+        return r;
+    }
+
+    vector<C> rev_a(k), rev_b(min(b.size(), k));
+    for (size_t i = 0; i < k; ++i) {
+        rev_a[i] = a[a.size() - 1 - i];
+    }
+    for (size_t i = 0; i < rev_b.size(); ++i) {
+        rev_b[i] = b[m - i];
+    }
+    vector<C> rev_q = truncated(poly_kernels::convolve(rev_a, inverse_series(rev_b, k)), k);
+    reverse(rev_q.begin(), rev_q.end());
+
+    vector<C> qb = poly_kernels::convolve(rev_q, b);
+    vector<C> r(m);
+    for (size_t i = 0; i < m; ++i) {
+        r[i] = coefficient_traits<C>::sub(a[i], qb[i]);
+    }
+    return r;
+}
+
+// 建树: 叶子块直接逐个乘 (x - a_i), 之后两两相乘
+template <typename C>
+SubproductTree<C>::SubproductTree(const vector<C>& points) : points_(points) {
+    vector<vector<C>> leaves;
+    for (size_t start = 0; start < points_.size(); start += LEAF_POINTS) {
+        size_t end = min(start + LEAF_POINTS, points_.size());
+        vector<C> poly(1, C(1));
+        for (size_t i = start; i < end; ++i) {
+            // poly *= (x - a_i)
+            poly.push_back(C());
+            for (size_t j = poly.size() - 1; j > 0; --j) {
+                poly[j] = coefficient_traits<C>::sub(poly[j - 1], coefficient_traits<C>::mul(points_[i], poly[j]));
+            }
+            poly[0] = coefficient_traits<C>::negate(coefficient_traits<C>::mul(points_[i], poly[0]));
+        }
+        leaves.push_back(std::move(poly));
+    }
+    if (leaves.empty()) {
+        leaves.push_back(vector<C>(1, C(1)));
+    }
+    levels_.push_back(std::move(leaves));
+
+    while (levels_.back().size() > 1) {
+        const vector<vector<C>>& below = levels_.back();
+        vector<vector<C>> level;
+        for (size_t j = 0; j + 1 < below.size(); j += 2) {
+            level.push_back(poly_kernels::convolve(below[j], below[j + 1]));
+        }
+        if (below.size() % 2 == 1) {
+            level.push_back(below.back());
+        }
+        levels_.push_back(std::move(level));
+    }
+}
+
+template <typename C>
+void SubproductTree<C>::descend(size_t level, size_t index, const vector<C>& r, C* out) const {
+    if (level == 0) {
+        size_t start = index * LEAF_POINTS;
+        size_t end = min(start + LEAF_POINTS, points_.size());
+        for (size_t i = start; i < end; ++i) {
+            out[i] = horner(r, points_[i]);
+        }
+        return;
+    }
+
+    const vector<vector<C>>& below = levels_[level - 1];
+    size_t left = 2 * index;
+    if (left + 1 >= below.size()) {
+        // 只有一个子节点, 与本节点相同
+        descend(level - 1, left, r, out);
+        return;
+    }
+    descend(level - 1, left, remainder(r, below[left]), out);
+    descend(level - 1, left + 1, remainder(r, below[left + 1]), out);
+}
+
+template <typename C>
+vector<C> SubproductTree<C>::evaluate(const vector<C>& coeffs) const {
+    vector<C> values(points_.size());
+    if (points_.empty()) {
+        return values;
+    }
+    descend(levels_.size() - 1, 0, remainder(coeffs, root()), values.data());
+    return values;
+}
+
+template <typename C>
+vector<C> evaluate_multipoint(const vector<C>& coeffs, const vector<C>& points) {
+    return SubproductTree<C>(points).evaluate(coeffs);
+}
+
+// 显式实例化
+#define POLY_MULTIPOINT_INSTANTIATE(C)                                                   \
+    template vector<C> inverse_series<C>(const vector<C>& h, size_t n);                 \
+    template vector<C> remainder<C>(const vector<C>& a, const vector<C>& b);            \
+    template class SubproductTree<C>;                                                    \
+    template vector<C> evaluate_multipoint<C>(const vector<C>& coeffs, const vector<C>& points);
+
+POLY_MULTIPOINT_INSTANTIATE(int)
+POLY_MULTIPOINT_INSTANTIATE(int64_t)
+#if POLYNOMIAL_HAS_INT128
+POLY_MULTIPOINT_INSTANTIATE(__int128)
+#endif
+POLY_MULTIPOINT_INSTANTIATE(Zp)
+POLY_MULTIPOINT_INSTANTIATE(BigInt)
+
+#undef POLY_MULTIPOINT_INSTANTIATE
+
+} // namespace poly_multipoint
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "coefficient.hpp"
+
+// 多点求值: 子乘积树 + 快速取余
+// 系数数组按指数升序存放 (a[i] 为 x^i 的系数); 只使用环上的加减乘, 除式均为首一多项式,
+// 因此对所有系数类型都精确 (定宽整数经 coefficient_traits 按补码回绕, 与逐点 Horner 的结果一致)
+namespace poly_multipoint {
+
+// 叶子块的点数: 树的叶子为每块点的 (x - a_i) 之积, 降到叶子后对余式逐点 Horner
+static const size_t LEAF_POINTS = 32;
+
+// 商的长度不超过该值时使用朴素长除法, 否则用 Newton 迭代求逆后相乘
+static const size_t FAST_REMAINDER_THRESHOLD = 64;
+
+// 幂级数求逆: 返回 g 使 h * g = 1 (mod x^n), 要求 h[0] = 1
+template <typename C>
+std::vector<C> inverse_series(const std::vector<C>& h, size_t n);
+
+// a mod b, b 为首一多项式 (最高位系数为 1), 结果长度为 deg(b)
+template <typename C>
+std::vector<C> remainder(const std::vector<C>& a, const std::vector<C>& b);
+
+// 子乘积树: 第 0 层为叶子块, 第 k 层的节点为第 k-1 层相邻两个节点之积, 顶层只有一个节点
+// 构造 O(M(n) log n), 每次求值 O(M(n) log n), M(n) 为 n 次多项式乘法的代价
+template <typename C>
+class SubproductTree {
+private:
+    std::vector<C> points_;                       // 求值点
+    std::vector<std::vector<std::vector<C>>> levels_;  // levels_[k][j] 为第 k 层第 j 个节点
+
+    // 自顶向下取余, r 已对第 level 层第 index 个节点取余
+    void descend(size_t level, size_t index, const std::vector<C>& r, C* out) const;
+
+public:
+
+    explicit SubproductTree(const std::vector<C>& points);
+
+    size_t size() const { return points_.size(); }
+
+    // 所有点的 (x - a_i) 之积
+    const std::vector<C>& root() const { return levels_.back().front(); }
+
+    // 在所有点上求值, 结果顺序与构造时的点一致
+    std::vector<C> evaluate(const std::vector<C>& coeffs) const;
+};
+
+// 一次性多点求值: 建树后求值
+template <typename C>
+std::vector<C> evaluate_multipoint(const std::vector<C>& coeffs, const std::vector<C>& points);
+
+} // namespace poly_multipoint
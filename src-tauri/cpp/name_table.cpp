@@ -0,0 +1,92 @@
+#include "name_table.hpp"
+
+using namespace std;
+
+// FNV-1a, 再做一次混合使低位分布均匀 (表的下标取低位)
+uint32_t NameTable::hash(string_view name) {
+    uint32_t h = 2166136261u;
+    for (char c : name) {
+        h = (h ^ static_cast<unsigned char>(c)) * 16777619u;
+    }
+    h ^= h >> 15;
+    h *= 0x2C1B3C6Du;
+    h ^= h >> 12;
+    return h;
+}
+
+uint32_t NameTable::find(string_view name) const {
+    if (slots_.empty()) {
+        return NOT_FOUND;
+    }
+
+    uint32_t h = hash(name);
+    size_t mask = slots_.size() - 1;
+    for (size_t slot = h & mask;; slot = (slot + 1) & mask) {
+        const Slot& entry = slots_[slot];
+        if (entry.id == NOT_FOUND) {
+            return NOT_FOUND;
+        }
+        if (entry.hash == h && this->name(entry.id) == name) {
+            return entry.id;
+        }
+    }
+}
+
+uint32_t NameTable::intern(string_view name) {
+    if (2 * (size() + 1) > slots_.size()) {
+        grow();
+    }
+
+    uint32_t h = hash(name);
+    size_t mask = slots_.size() - 1;
+    size_t slot = h & mask;
+    for (;; slot = (slot + 1) & mask) {
+        const Slot& entry = slots_[slot];
+        if (entry.id == NOT_FOUND) {
+            break;
+        }
+        if (entry.hash == h && this->name(entry.id) == name) {
+            return entry.id;
+        }
+    }
+
+    uint32_t id = static_cast<uint32_t>(size());
+    pool_.insert(pool_.end(), name.begin(), name.end());
+    offsets_.push_back(static_cast<uint32_t>(pool_.size()));
+    slots_[slot] = {h, id};
+    return id;
+}
+
+void NameTable::clear() {
+    slots_.clear();
+    pool_.clear();
+    offsets_.assign(1, 0);
+}
+
+bool NameTable::is_identifier(string_view name) {
+    if (name.empty() || !is_identifier_start(name[0])) {
+        return false;
+    }
+    for (char c : name) {
+        if (!is_identifier_char(c)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void NameTable::grow() {
+    vector<Slot> slots(slots_.empty() ? 16 : slots_.size() * 2, Slot{0, NOT_FOUND});
+    size_t mask = slots.size() - 1;
+    for (const Slot& entry : slots_) {
+        if (entry.id == NOT_FOUND) {
+            continue;
+        }
+        size_t slot = entry.hash & mask;
+        while (slots[slot].id != NOT_FOUND) {
+            slot = (slot + 1) & mask;
+        }
+        slots[slot] = entry;
+    }
+    slots_.swap(slots);
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+// 多项式名称的驻留表: 每个不同的名称分配一个从 0 开始的连续编号, 编号在 clear 之前不变
+// 名称的字符连续存放在一个字符池中, 哈希表为开放寻址 (线性探测), 槽位只有 8 字节 (哈希值 + 编号),
+// 探测时先比较哈希值, 相同才比较字符; 负载不超过 1/2, 因此查找代价与表的大小无关
+class NameTable {
+public:
+    static constexpr uint32_t NOT_FOUND = UINT32_MAX;
+
+    // 查找名称的编号, 不存在时返回 NOT_FOUND
+    uint32_t find(std::string_view name) const;
+
+    // 返回名称的编号, 不存在时登记为新编号 (等于登记前的 size())
+    uint32_t intern(std::string_view name);
+
+    // 编号对应的名称, 在下一次 intern 或 clear 之前有效
+    std::string_view name(uint32_t id) const {
+        return std::string_view(pool_.data() + offsets_[id], offsets_[id + 1] - offsets_[id]);
+    }
+
+    size_t size() const { return offsets_.size() - 1; }
+
+    void clear();
+
+    // 名称是否为合法标识符: 字母或下划线开头, 之后为字母、数字或下划线
+    static bool is_identifier(std::string_view name);
+
+    static bool is_identifier_start(char c) {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_';
+    }
+
+    static bool is_identifier_char(char c) {
+        return is_identifier_start(c) || (c >= '0' && c <= '9');
+    }
+
+private:
+    struct Slot {
+        uint32_t hash;
+        uint32_t id;  // NOT_FOUND 为空槽
+    };
+
+    std::vector<Slot> slots_;          // 容量为 2 的幂
+    std::vector<char> pool_;           // 所有名称的字符, 按编号顺序首尾相接
+    std::vector<uint32_t> offsets_{0}; // 编号 i 的名称为 pool_[offsets_[i], offsets_[i + 1])
+
+    static uint32_t hash(std::string_view name);
+
+    // 容量翻倍后按已保存的哈希值重新放置, 不需要重新计算
+    void grow();
+};
@@ -0,0 +1,83 @@
+#include "poly_arena.hpp"
+
+#include <cstdint>
+#include <new>
+
+using namespace std;
+
+thread_local PolynomialArena* PolynomialArena::current_ = nullptr;
+
+PolynomialArena::PolynomialArena(size_t chunk_size)
+    : cursor_(nullptr), end_(nullptr), next_chunk_size_(chunk_size > 0 ? chunk_size : DEFAULT_CHUNK_SIZE),
+      bytes_allocated_(0) {
+}
+
+PolynomialArena::~PolynomialArena() {
+    for (const Chunk& chunk : chunks_) {
+        ::operator delete(chunk.data);
+    }
+}
+
+void PolynomialArena::add_chunk(size_t min_size) {
+    size_t size = next_chunk_size_;
+    while (size < min_size) {
+        size *= 2;
+    }
+    char* data = static_cast<char*>(::operator new(size));
+    chunks_.push_back({data, size});
+    cursor_ = data;
+    end_ = data + size;
+    next_chunk_size_ = size * 2;
+}
+
+void* PolynomialArena::allocate(size_t bytes, size_t alignment) {
+    uintptr_t p = (reinterpret_cast<uintptr_t>(cursor_) + alignment - 1) & ~(uintptr_t)(alignment - 1);
+    if (cursor_ == nullptr || p + bytes > reinterpret_cast<uintptr_t>(end_)) {
+        // 新块起始地址按 operator new 的默认对齐, 多留 alignment 字节保证对齐后放得下
+        add_chunk(bytes + alignment);
+        p = (reinterpret_cast<uintptr_t>(cursor_) + alignment - 1) & ~(uintptr_t)(alignment - 1);
+    }
+    cursor_ = reinterpret_cast<char*>(p + bytes);
+    bytes_allocated_ += bytes;
+    return reinterpret_cast<void*>(p);
+}
+
+void PolynomialArena::reset() {
+    // 保留不超过上限的最大一块, 其余归还
+    size_t keep = chunks_.size();
+    for (size_t i = 0; i < chunks_.size(); ++i) {
+        if (chunks_[i].size <= MAX_RETAINED_SIZE && (keep == chunks_.size() || chunks_[i].size > chunks_[keep].size)) {
+            keep = i;
+        }
+    }
+    for (size_t i = 0; i < chunks_.size(); ++i) {
+        if (i != keep) {
+            ::operator delete(chunks_[i].data);
+        }
+    }
+    if (keep < chunks_.size()) {
+        Chunk kept = chunks_[keep];
+        chunks_.assign(1, kept);
+        cursor_ = kept.data;
+        end_ = kept.data + kept.size;
+        next_chunk_size_ = kept.size * 2;
+    } else {
+        chunks_.clear();
+        cursor_ = nullptr;
+        end_ = nullptr;
+        next_chunk_size_ = MAX_RETAINED_SIZE;
+    }
+    bytes_allocated_ = 0;
+}
+
+PolynomialArena* PolynomialArena::current() {
+    return current_;
+}
+
+ArenaScope::ArenaScope(PolynomialArena& arena) : previous_(PolynomialArena::current_) {
+    PolynomialArena::current_ = &arena;
+}
+
+ArenaScope::~ArenaScope() {
+    PolynomialArena::current_ = previous_;
+}
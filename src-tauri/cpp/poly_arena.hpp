@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// 单调分配器: 从大块内存中顺序切分, 单次释放无操作, reset 时整体回收
+// 用于表达式求值期间的临时多项式: 求值结束后整体释放, 不产生碎片
+class PolynomialArena {
+public:
+    // 首块大小; 之后每块翻倍
+    static constexpr size_t DEFAULT_CHUNK_SIZE = 64 * 1024;
+
+    // reset 后最多保留的内存, 超过的块归还系统
+    static constexpr size_t MAX_RETAINED_SIZE = 4 * 1024 * 1024;
+
+    explicit PolynomialArena(size_t chunk_size = DEFAULT_CHUNK_SIZE);
+    ~PolynomialArena();
+
+    PolynomialArena(const PolynomialArena&) = delete;
+    PolynomialArena& operator=(const PolynomialArena&) = delete;
+
+    // 分配 bytes 字节, alignment 为 2 的幂
+    void* allocate(size_t bytes, size_t alignment);
+
+    // 回收所有分配 (调用方保证其中的对象已析构); 保留不超过 MAX_RETAINED_SIZE 的最大一块供下次使用
+    void reset();
+
+    // 自上次 reset 以来分配的字节数
+    size_t bytes_allocated() const { return bytes_allocated_; }
+
+    // 当前持有的内存块数
+    size_t chunk_count() const { return chunks_.size(); }
+
+    // 当前线程正在使用的分配器, 没有时返回 nullptr
+    static PolynomialArena* current();
+
+private:
+    friend class ArenaScope;
+
+    struct Chunk {
+        char* data;
+        size_t size;
+    };
+
+    std::vector<Chunk> chunks_;  // 已申请的块, 最后一块为当前块
+    char* cursor_;               // 当前块中下一个可用位置
+    char* end_;                  // 当前块末尾
+    size_t next_chunk_size_;     // 下一次申请的块大小
+    size_t bytes_allocated_;
+
+    // 申请至少 min_size 字节的新块并设为当前块
+    void add_chunk(size_t min_size);
+
+    static thread_local PolynomialArena* current_;
+};
+
+// 作用域内把 arena 设为当前线程的分配器, 离开时恢复之前的分配器 (可嵌套)
+class ArenaScope {
+public:
+    explicit ArenaScope(PolynomialArena& arena);
+    ~ArenaScope();
+
+    ArenaScope(const ArenaScope&) = delete;
+    ArenaScope& operator=(const ArenaScope&) = delete;
+
+private:
+    PolynomialArena* previous_;
+};
@@ -0,0 +1,472 @@
+#include "poly_multiply.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+using namespace std;
+
+namespace poly_kernels {
+
+// 3 在模 2^64 下的乘法逆元, 用于精确除以 3
+static const uint64_t INVERSE_OF_3 = 0xAAAAAAAAAAAAAAABULL;
+
+static size_t workspace_size(size_t n, bool allow_toom);
+static void balanced(const uint64_t* a, const uint64_t* b, size_t n, uint64_t* out, uint64_t* ws, bool allow_toom);
+static void karatsuba(const uint64_t* a, const uint64_t* b, size_t n, uint64_t* out, uint64_t* ws, bool allow_toom);
+static void toom3(const uint64_t* a, const uint64_t* b, size_t n, uint64_t* out, uint64_t* ws);
+
+// 朴素平方: 交叉项 a[i] a[j] (i < j) 只乘一次再加倍, 乘法次数约为朴素乘法的一半
+static void square_schoolbook(const uint64_t* a, size_t n, uint64_t* out) {
+    fill(out, out + 2 * n - 1, 0);
+    for (size_t i = 0; i < n; ++i) {
+        uint64_t coeff = a[i];
+        if (coeff == 0) {
+            continue;
+        }
+        uint64_t* dst = out + i;
+        for (size_t j = i + 1; j < n; ++j) {
+            dst[j] += coeff * a[j];
+        }
+    }
+    for (size_t i = 0; i < 2 * n - 1; ++i) {
+        out[i] <<= 1;
+    }
+    for (size_t i = 0; i < n; ++i) {
+        out[2 * i] += a[i] * a[i];
+    }
+}
+
+// 朴素乘法 (a 与 b 为同一数组时按平方计算)
+void multiply_schoolbook(const uint64_t* a, size_t la, const uint64_t* b, size_t lb, uint64_t* out) {
+    if (a == b && la == lb) {
+        square_schoolbook(a, la, out);
+        return;
+    }
+    fill(out, out + la + lb - 1, 0);
+    for (size_t i = 0; i < la; ++i) {
+        uint64_t coeff = a[i];
+        if (coeff == 0) {
+            continue;
+        }
+        uint64_t* dst = out + i;
+        for (size_t j = 0; j < lb; ++j) {
+            dst[j] += coeff * b[j];
+        }
+    }
+}
+
+// 递归所需的临时空间 (各层依次向后使用同一块缓冲区)
+static size_t workspace_size(size_t n, bool allow_toom) {
+    if (n <= KARATSUBA_THRESHOLD) {
+        return 0;
+    }
+    if (allow_toom && n >= TOOM3_THRESHOLD) {
+        size_t k = (n + 2) / 3;
+        return 16 * k + workspace_size(k, allow_toom);
+    }
+    size_t h = (n + 1) / 2;
+    return 4 * h + workspace_size(h, allow_toom);
+}
+
+// 等长乘法的递归分派; a 与 b 为同一数组时各层都只准备一侧的求值数组, 递归到底按平方计算
+static void balanced(const uint64_t* a, const uint64_t* b, size_t n, uint64_t* out, uint64_t* ws, bool allow_toom) {
+    if (n <= KARATSUBA_THRESHOLD) {
+        multiply_schoolbook(a, n, b, n, out);
+    } else if (allow_toom && n >= TOOM3_THRESHOLD) {
+        toom3(a, b, n, out, ws);
+    } else {
+        karatsuba(a, b, n, out, ws, allow_toom);
+    }
+}
+
+// Karatsuba: a = a0 + a1 x^h, b = b0 + b1 x^h
+// z0 = a0 b0, z2 = a1 b1 直接写入 out 的低 / 高两段, z1 = (a0 + a1)(b0 + b1) - z0 - z2 叠加到中间
+static void karatsuba(const uint64_t* a, const uint64_t* b, size_t n, uint64_t* out, uint64_t* ws, bool allow_toom) {
+    size_t h = (n + 1) / 2;
+    size_t l = n - h;
+
+    uint64_t* z1 = ws;            // 2h - 1
+    uint64_t* sa = z1 + 2 * h - 1; // h
+    uint64_t* sb = sa + h;         // h
+    uint64_t* next = sb + h;
+
+    balanced(a, b, h, out, next, allow_toom);
+    out[2 * h - 1] = 0;
+    balanced(a + h, b + h, l, out + 2 * h, next, allow_toom);
+
+    for (size_t i = 0; i < h; ++i) {
+        sa[i] = a[i] + (i < l ? a[h + i] : 0);
+    }
+    if (a == b) {
+        sb = sa;
+    } else {
+        for (size_t i = 0; i < h; ++i) {
+            sb[i] = b[i] + (i < l ? b[h + i] : 0);
+        }
+    }
+    balanced(sa, sb, h, z1, next, allow_toom);
+
+    for (size_t i = 0; i < 2 * h - 1; ++i) {
+        z1[i] -= out[i];
+    }
+    for (size_t i = 0; i + 1 < 2 * l; ++i) {
+        z1[i] -= out[2 * h + i];
+    }
+    for (size_t i = 0; i < 2 * h - 1; ++i) {
+        out[h + i] += z1[i];
+    }
+}
+
+// Toom-3: 把 a, b 三等分后在 0, 1, -1, -2, ∞ 五个点求值, 五次递归相乘后按 Bodrato 序列插值
+static void toom3(const uint64_t* a, const uint64_t* b, size_t n, uint64_t* out, uint64_t* ws) {
+    size_t k = (n + 2) / 3;
+    size_t l2 = n - 2 * k;  // 最高段长度, 1 <= l2 <= k
+    size_t lr = 2 * k - 1;  // 每个点值乘积的长度
+
+    uint64_t* pa1 = ws;
+    uint64_t* pam1 = pa1 + k;
+    uint64_t* pam2 = pam1 + k;
+    uint64_t* pb1 = pam2 + k;
+    uint64_t* pbm1 = pb1 + k;
+    uint64_t* pbm2 = pbm1 + k;
+    uint64_t* r0 = pbm2 + k;
+    uint64_t* r1 = r0 + lr;
+    uint64_t* rm1 = r1 + lr;
+    uint64_t* rm2 = rm1 + lr;
+    uint64_t* rinf = rm2 + lr;
+    uint64_t* next = rinf + lr;
+
+    const uint64_t* a0 = a;
+    const uint64_t* a1 = a + k;
+    const uint64_t* a2 = a + 2 * k;
+    const uint64_t* b0 = b;
+    const uint64_t* b1 = b + k;
+    const uint64_t* b2 = b + 2 * k;
+
+    for (size_t i = 0; i < k; ++i) {
+        uint64_t x2 = i < l2 ? a2[i] : 0;
+        pa1[i] = a0[i] + a1[i] + x2;
+        pam1[i] = a0[i] - a1[i] + x2;
+        pam2[i] = a0[i] - 2 * a1[i] + 4 * x2;
+    }
+    if (a == b) {
+        pb1 = pa1;
+        pbm1 = pam1;
+        pbm2 = pam2;
+    } else {
+        for (size_t i = 0; i < k; ++i) {
+            uint64_t y2 = i < l2 ? b2[i] : 0;
+            pb1[i] = b0[i] + b1[i] + y2;
+            pbm1[i] = b0[i] - b1[i] + y2;
+            pbm2[i] = b0[i] - 2 * b1[i] + 4 * y2;
+        }
+    }
+
+    balanced(a0, b0, k, r0, next, true);
+    balanced(pa1, pb1, k, r1, next, true);
+    balanced(pam1, pbm1, k, rm1, next, true);
+    balanced(pam2, pbm2, k, rm2, next, true);
+    balanced(a2, b2, l2, rinf, next, true);
+    fill(rinf + 2 * l2 - 1, rinf + lr, 0);
+
+    size_t len = 2 * n - 1;
+    fill(out, out + len, 0);
+    for (size_t i = 0; i < lr; ++i) {
+        uint64_t c0 = r0[i];
+        uint64_t c4 = rinf[i];
+        uint64_t c3 = (rm2[i] - r1[i]) * INVERSE_OF_3;
+        uint64_t c1 = (r1[i] - rm1[i]) >> 1;
+        uint64_t c2 = rm1[i] - c0;
+        c3 = ((c2 - c3) >> 1) + 2 * c4;
+        c2 = c2 + c1 - c4;
+        c1 = c1 - c3;
+
+        out[i] += c0;
+        if (k + i < len) out[k + i] += c1;
+        if (2 * k + i < len) out[2 * k + i] += c2;
+        if (3 * k + i < len) out[3 * k + i] += c3;
+        if (4 * k + i < len) out[4 * k + i] += c4;
+    }
+}
+
+// ============================================================================
+// 数论变换 (NTT)
+// ============================================================================
+
+// NTT 友好素数 p = c * 2^k + 1, 按 2 的幂次从高到低排列, 使前几个素数支持的变换长度最大
+struct NttPrime {
+    uint32_t mod;
+    uint32_t root;     // 原根
+    int max_log;       // 支持的最大变换长度 2^max_log
+};
+
+static const NttPrime NTT_PRIMES[] = {
+    {469762049u, 3u, 26},   // 7 * 2^26 + 1
+    {167772161u, 3u, 25},   // 5 * 2^25 + 1
+    {754974721u, 11u, 24},  // 45 * 2^24 + 1
+    {998244353u, 3u, 23},   // 119 * 2^23 + 1
+    {1004535809u, 3u, 21},  // 479 * 2^21 + 1
+};
+static const int NTT_PRIME_COUNT = 5;
+
+static uint32_t pow_mod(uint64_t base, uint64_t exp, uint32_t mod) {
+    uint64_t result = 1;
+    base %= mod;
+    while (exp > 0) {
+        if (exp & 1) {
+            result = result * base % mod;
+        }
+        base = base * base % mod;
+        exp >>= 1;
+    }
+    return static_cast<uint32_t>(result);
+}
+
+// 原地 NTT, 模数作为模板参数使取模编译为乘法
+template <uint32_t MOD>
+static void ntt_transform(vector<uint32_t>& a, uint32_t root, bool invert) {
+    size_t n = a.size();
+    for (size_t i = 1, j = 0; i < n; ++i) {
+        size_t bit = n >> 1;
+        for (; j & bit; bit >>= 1) {
+            j ^= bit;
+        }
+        j ^= bit;
+        if (i < j) {
+            swap(a[i], a[j]);
+        }
+    }
+
+    vector<uint32_t> w(n / 2);
+    for (size_t len = 2; len <= n; len <<= 1) {
+        uint32_t w_len = pow_mod(root, (MOD - 1) / len, MOD);
+        if (invert) {
+            w_len = pow_mod(w_len, MOD - 2, MOD);
+        }
+        size_t half = len / 2;
+        w[0] = 1;
+        for (size_t j = 1; j < half; ++j) {
+            w[j] = static_cast<uint32_t>(static_cast<uint64_t>(w[j - 1]) * w_len % MOD);
+        }
+        for (size_t i = 0; i < n; i += len) {
+            uint32_t* lo = a.data() + i;
+            uint32_t* hi = lo + half;
+            for (size_t j = 0; j < half; ++j) {
+                uint32_t u = lo[j];
+                uint32_t v = static_cast<uint32_t>(static_cast<uint64_t>(hi[j]) * w[j] % MOD);
+                lo[j] = u + v >= MOD ? u + v - MOD : u + v;
+                hi[j] = u >= v ? u - v : u + MOD - v;
+            }
+        }
+    }
+
+    if (invert) {
+        uint64_t n_inv = pow_mod(n, MOD - 2, MOD);
+        for (size_t i = 0; i < n; ++i) {
+            a[i] = static_cast<uint32_t>(a[i] * n_inv % MOD);
+        }
+    }
+}
+
+// 有符号 64 位值对素数取非负余数
+static uint32_t to_residue(uint64_t value, uint32_t mod) {
+    int64_t r = static_cast<int64_t>(value) % static_cast<int64_t>(mod);
+    return static_cast<uint32_t>(r < 0 ? r + mod : r);
+}
+
+// 在单个素数下计算卷积, 结果写入 residues[0..la+lb-1); 平方时只做一次正变换
+template <uint32_t MOD>
+static void ntt_convolve(const uint64_t* a, size_t la, const uint64_t* b, size_t lb, size_t n, uint32_t root,
+                         uint32_t* residues) {
+    vector<uint32_t> fa(n, 0);
+    for (size_t i = 0; i < la; ++i) {
+        fa[i] = to_residue(a[i], MOD);
+    }
+    ntt_transform<MOD>(fa, root, false);
+    if (a == b && la == lb) {
+        for (size_t i = 0; i < n; ++i) {
+            fa[i] = static_cast<uint32_t>(static_cast<uint64_t>(fa[i]) * fa[i] % MOD);
+        }
+    } else {
+        vector<uint32_t> fb(n, 0);
+        for (size_t i = 0; i < lb; ++i) {
+            fb[i] = to_residue(b[i], MOD);
+        }
+        ntt_transform<MOD>(fb, root, false);
+        for (size_t i = 0; i < n; ++i) {
+            fa[i] = static_cast<uint32_t>(static_cast<uint64_t>(fa[i]) * fb[i] % MOD);
+        }
+    }
+    ntt_transform<MOD>(fa, root, true);
+    copy(fa.begin(), fa.begin() + (la + lb - 1), residues);
+}
+
+static void ntt_convolve_prime(int index, const uint64_t* a, size_t la, const uint64_t* b, size_t lb, size_t n,
+                               uint32_t* residues) {
+    uint32_t root = NTT_PRIMES[index].root;
+    switch (index) {
+        case 0: ntt_convolve<469762049u>(a, la, b, lb, n, root, residues); break;
+        case 1: ntt_convolve<167772161u>(a, la, b, lb, n, root, residues); break;
+        case 2: ntt_convolve<754974721u>(a, la, b, lb, n, root, residues); break;
+        case 3: ntt_convolve<998244353u>(a, la, b, lb, n, root, residues); break;
+        default: ntt_convolve<1004535809u>(a, la, b, lb, n, root, residues); break;
+    }
+}
+
+// 按有符号解释的最大绝对值位数
+static int max_magnitude_bits(const uint64_t* a, size_t len) {
+    uint64_t max_abs = 0;
+    for (size_t i = 0; i < len; ++i) {
+        int64_t v = static_cast<int64_t>(a[i]);
+        uint64_t mag = v < 0 ? 0 - static_cast<uint64_t>(v) : static_cast<uint64_t>(v);
+        max_abs = max(max_abs, mag);
+    }
+    int bits = 0;
+    while (bits < 64 && (max_abs >> bits) != 0) {
+        ++bits;
+    }
+    return bits;
+}
+
+bool multiply_ntt(const uint64_t* a, size_t la, const uint64_t* b, size_t lb, uint64_t* out) {
+    size_t len = la + lb - 1;
+    size_t n = 1;
+    int log_n = 0;
+    while (n < len) {
+        n <<= 1;
+        ++log_n;
+    }
+
+    // 结果系数的绝对值上界: |a|max * |b|max * min(la, lb), 再加一位符号
+    int shorter_bits = 0;
+    while ((static_cast<size_t>(1) << shorter_bits) < min(la, lb)) {
+        ++shorter_bits;
+    }
+    double bound_bits = max_magnitude_bits(a, la) + max_magnitude_bits(b, lb) + shorter_bits + 1;
+
+    int k = 0;
+    double product_bits = 0;
+    while (k < NTT_PRIME_COUNT && product_bits <= bound_bits) {
+        product_bits += log2(static_cast<double>(NTT_PRIMES[k].mod));
+        ++k;
+    }
+    if (product_bits <= bound_bits) {
+        return false;
+    }
+    if (k < 2) {
+        k = 2;
+    }
+    if (log_n > NTT_PRIMES[k - 1].max_log) {
+        return false;
+    }
+
+    vector<vector<uint32_t>> residues(k, vector<uint32_t>(len));
+    for (int i = 0; i < k; ++i) {
+        ntt_convolve_prime(i, a, la, b, lb, n, residues[i].data());
+    }
+
+    // Garner: x = d0 + p0 (d1 + p1 (d2 + ...)), inverse[j][i] = p_j^-1 mod p_i
+    uint64_t inverse[NTT_PRIME_COUNT][NTT_PRIME_COUNT] = {};
+    uint64_t radix[NTT_PRIME_COUNT];   // p0 * ... * p_{i-1} mod 2^64
+    uint64_t modulus = 1;               // p0 * ... * p_{k-1} mod 2^64
+    for (int i = 0; i < k; ++i) {
+        uint32_t p_i = NTT_PRIMES[i].mod;
+        for (int j = 0; j < i; ++j) {
+            inverse[j][i] = pow_mod(NTT_PRIMES[j].mod, p_i - 2, p_i);
+        }
+        radix[i] = modulus;
+        modulus *= NTT_PRIMES[i].mod;
+    }
+
+    auto garner = [&](const uint32_t* r, uint32_t* digits) {
+        for (int i = 0; i < k; ++i) {
+            uint64_t p_i = NTT_PRIMES[i].mod;
+            uint64_t x = r[i];
+            for (int j = 0; j < i; ++j) {
+                x = (x + p_i - digits[j] % p_i) % p_i * inverse[j][i] % p_i;
+            }
+            digits[i] = static_cast<uint32_t>(x);
+        }
+    };
+
+    // (M - 1) / 2 在各素数下的余数为 (p - 1) / 2, 其混合进制数字用于判断结果正负
+    uint32_t half_residues[NTT_PRIME_COUNT];
+    uint32_t half_digits[NTT_PRIME_COUNT];
+    for (int i = 0; i < k; ++i) {
+        half_residues[i] = (NTT_PRIMES[i].mod - 1) / 2;
+    }
+    garner(half_residues, half_digits);
+
+    uint32_t r[NTT_PRIME_COUNT];
+    uint32_t digits[NTT_PRIME_COUNT];
+    for (size_t idx = 0; idx < len; ++idx) {
+        for (int i = 0; i < k; ++i) {
+            r[i] = residues[i][idx];
+        }
+        garner(r, digits);
+
+        uint64_t value = 0;
+        for (int i = 0; i < k; ++i) {
+            value += digits[i] * radix[i];
+        }
+
+        // 混合进制数字按高位优先比较即为数值比较, 大于 (M - 1) / 2 表示负数
+        bool negative = false;
+        for (int i = k - 1; i >= 0; --i) {
+            if (digits[i] != half_digits[i]) {
+                negative = digits[i] > half_digits[i];
+                break;
+            }
+        }
+        out[idx] = negative ? value - modulus : value;
+    }
+    return true;
+}
+
+// ============================================================================
+// 对外接口
+// ============================================================================
+
+void multiply_balanced(const uint64_t* a, const uint64_t* b, size_t n, uint64_t* out, bool allow_toom) {
+    vector<uint64_t> ws(workspace_size(n, allow_toom));
+    balanced(a, b, n, out, ws.data(), allow_toom);
+}
+
+void multiply_coefficients(const uint64_t* a, size_t la, const uint64_t* b, size_t lb, uint64_t* out,
+                           bool allow_toom) {
+    if (la < lb) {
+        swap(a, b);
+        swap(la, lb);
+    }
+    if (lb <= KARATSUBA_THRESHOLD) {
+        multiply_schoolbook(a, la, b, lb, out);
+        return;
+    }
+    if (lb >= NTT_THRESHOLD && multiply_ntt(a, la, b, lb, out)) {
+        return;
+    }
+
+    // 较长一侧按 lb 分块, 每块与 b 做等长乘法后叠加, 最后一块不足时补零
+    size_t len = la + lb - 1;
+    fill(out, out + len, 0);
+    vector<uint64_t> chunk(lb, 0);
+    vector<uint64_t> product(2 * lb - 1);
+    vector<uint64_t> ws(workspace_size(lb, allow_toom));
+
+    for (size_t start = 0; start < la; start += lb) {
+        size_t chunk_len = min(lb, la - start);
+        const uint64_t* src = a + start;
+        if (chunk_len < lb) {
+            copy(src, src + chunk_len, chunk.begin());
+            fill(chunk.begin() + chunk_len, chunk.end(), 0);
+            src = chunk.data();
+        }
+        balanced(src, b, lb, product.data(), ws.data(), allow_toom);
+        for (size_t i = 0; i < chunk_len + lb - 1; ++i) {
+            out[start + i] += product[i];
+        }
+    }
+}
+
+} // namespace poly_kernels
@@ -0,0 +1,210 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "coefficient.hpp"
+
+// 稠密多项式乘法内核
+// 系数数组按指数升序存放 (a[i] 为 x^i 的系数), 运算在 2^64 的剩余类环上进行,
+// 因此结果截断到 int 后与逐项相乘的补码溢出结果一致
+namespace poly_kernels {
+
+// 低于该长度使用朴素乘法
+static const size_t KARATSUBA_THRESHOLD = 32;
+
+// 不低于该长度使用 Toom-3
+static const size_t TOOM3_THRESHOLD = 192;
+
+// 较短一侧不低于该长度时使用数论变换 (NTT)
+static const size_t NTT_THRESHOLD = 8192;
+
+// 以下乘法在 a 与 b 为同一数组 (且等长) 时按平方计算: 朴素乘法的交叉项只乘一次,
+// Karatsuba / Toom-3 每层只准备一侧的求值数组, NTT 只做一次正变换
+
+// 朴素乘法: out[0..la+lb-1) = a * b
+void multiply_schoolbook(const uint64_t* a, size_t la, const uint64_t* b, size_t lb, uint64_t* out);
+
+// 等长乘法: out[0..2n-1) = a * b, 按长度在朴素 / Karatsuba / Toom-3 之间递归选择
+// Toom-3 的插值含除以 2, 每层递归损失最高一位, 仅当调用方只需要低 32 位时才应开启 allow_toom
+void multiply_balanced(const uint64_t* a, const uint64_t* b, size_t n, uint64_t* out, bool allow_toom);
+
+// 数论变换乘法: 输入按有符号 64 位整数解释, 根据系数位数与长度选择 2~5 个 NTT 友好素数,
+// 各素数下分别卷积后用 Garner 算法 (中国剩余定理) 重建, 结果在 2^64 下精确
+// 所需素数超过 5 个或长度超过变换上限时返回 false, 由调用方改用其他算法
+bool multiply_ntt(const uint64_t* a, size_t la, const uint64_t* b, size_t lb, uint64_t* out);
+
+// 任意长度乘法: out[0..la+lb-1) = a * b
+// 较短一侧达到 NTT_THRESHOLD 时优先使用 NTT, 否则较长的一侧按较短一侧的长度分块
+void multiply_coefficients(const uint64_t* a, size_t la, const uint64_t* b, size_t lb, uint64_t* out,
+                           bool allow_toom);
+
+// ----------------------------------------------------------------------------
+// 通用系数类型 (__int128 / 模素数 / 任意精度) 的乘法
+// 这些类型不能按补码放进 uint64_t, 只使用 coefficient_traits 的加减乘, 因此用不含除法的 Karatsuba
+// ----------------------------------------------------------------------------
+
+// 朴素乘法: out[0..la+lb-1) = a * b
+template <typename T>
+void multiply_schoolbook_generic(const T* a, size_t la, const T* b, size_t lb, T* out) {
+    for (size_t i = 0; i < la + lb - 1; ++i) {
+        out[i] = T();
+    }
+    if (a == b && la == lb) {
+        // 平方: 交叉项只乘一次再加倍
+        for (size_t i = 0; i < la; ++i) {
+            if (a[i] == T()) {
+                continue;
+            }
+            for (size_t j = i + 1; j < la; ++j) {
+                coefficient_traits<T>::add_to(out[i + j], coefficient_traits<T>::mul(a[i], a[j]));
+            }
+        }
+        for (size_t i = 0; i < 2 * la - 1; ++i) {
+            coefficient_traits<T>::add_to(out[i], out[i]);
+        }
+        for (size_t i = 0; i < la; ++i) {
+            coefficient_traits<T>::add_to(out[2 * i], coefficient_traits<T>::mul(a[i], a[i]));
+        }
+        return;
+    }
+    for (size_t i = 0; i < la; ++i) {
+        if (a[i] == T()) {
+            continue;
+        }
+        for (size_t j = 0; j < lb; ++j) {
+            coefficient_traits<T>::add_to(out[i + j], coefficient_traits<T>::mul(a[i], b[j]));
+        }
+    }
+}
+
+// 等长 Karatsuba: out[0..2n-1) = a * b
+// a = a0 + a1 x^h, b = b0 + b1 x^h, z1 = (a0 + a1)(b0 + b1) - a0 b0 - a1 b1
+template <typename T>
+void multiply_karatsuba_generic(const T* a, const T* b, size_t n, T* out) {
+    if (n <= KARATSUBA_THRESHOLD) {
+        multiply_schoolbook_generic(a, n, b, n, out);
+        return;
+    }
+
+    size_t h = n / 2;   // 低半段长度
+    size_t hh = n - h;  // 高半段长度 (hh >= h)
+
+    bool square = a == b;
+    std::vector<T> z0(2 * h - 1), z2(2 * hh - 1), z1(2 * hh - 1), sa(hh), sb(square ? 0 : hh);
+    multiply_karatsuba_generic(a, b, h, z0.data());
+    multiply_karatsuba_generic(a + h, b + h, hh, z2.data());
+    for (size_t i = 0; i < hh; ++i) {
+        sa[i] = a[h + i];
+        if (i < h) {
+            coefficient_traits<T>::add_to(sa[i], a[i]);
+        }
+        if (!square) {
+            sb[i] = b[h + i];
+            if (i < h) {
+                coefficient_traits<T>::add_to(sb[i], b[i]);
+            }
+        }
+    }
+    multiply_karatsuba_generic(sa.data(), square ? sa.data() : sb.data(), hh, z1.data());
+    for (size_t i = 0; i < z0.size(); ++i) {
+        coefficient_traits<T>::subtract_from(z1[i], z0[i]);
+    }
+    for (size_t i = 0; i < z2.size(); ++i) {
+        coefficient_traits<T>::subtract_from(z1[i], z2[i]);
+    }
+
+    for (size_t i = 0; i < 2 * n - 1; ++i) {
+        out[i] = T();
+    }
+    for (size_t i = 0; i < z0.size(); ++i) {
+        coefficient_traits<T>::add_to(out[i], z0[i]);
+    }
+    for (size_t i = 0; i < z2.size(); ++i) {
+        coefficient_traits<T>::add_to(out[2 * h + i], z2[i]);
+    }
+    for (size_t i = 0; i < z1.size(); ++i) {
+        coefficient_traits<T>::add_to(out[h + i], z1[i]);
+    }
+}
+
+// 任意长度乘法: 较长一侧按较短一侧的长度分块, 每块做等长 Karatsuba
+template <typename T>
+void multiply_generic(const T* a, size_t la, const T* b, size_t lb, T* out) {
+    if (la < lb) {
+        std::swap(a, b);
+        std::swap(la, lb);
+    }
+    if (lb <= KARATSUBA_THRESHOLD) {
+        multiply_schoolbook_generic(a, la, b, lb, out);
+        return;
+    }
+
+    for (size_t i = 0; i < la + lb - 1; ++i) {
+        out[i] = T();
+    }
+    std::vector<T> block(2 * lb - 1);
+    for (size_t offset = 0; offset < la; offset += lb) {
+        size_t len = la - offset < lb ? la - offset : lb;
+        if (len == lb) {
+            multiply_karatsuba_generic(a + offset, b, lb, block.data());
+        } else {
+            multiply_schoolbook_generic(b, lb, a + offset, len, block.data());
+        }
+        for (size_t i = 0; i < len + lb - 1; ++i) {
+            coefficient_traits<T>::add_to(out[offset + i], block[i]);
+        }
+    }
+}
+
+// 系数数组卷积 (a[i] 为 x^i 的系数, 两侧均非空), a 与 b 为同一对象时按平方计算
+// 较短一侧不超过 KARATSUBA_THRESHOLD 时直接朴素相乘, 否则
+//  - 机器字系数 (int / int64_t): 按补码放进 64 位无符号数组调用 Karatsuba / Toom-3 / NTT 内核,
+//    结果截断回 C; Toom-3 仅在只需低 32 位时启用
+//  - 其他系数: 通用 Karatsuba
+template <typename C>
+std::vector<C> convolve(const std::vector<C>& a, const std::vector<C>& b) {
+    std::vector<C> coeffs(a.size() + b.size() - 1, C());
+    bool square = &a == &b;
+
+    if (std::min(a.size(), b.size()) <= KARATSUBA_THRESHOLD) {
+        if (square) {
+            multiply_schoolbook_generic(a.data(), a.size(), a.data(), a.size(), coeffs.data());
+            return coeffs;
+        }
+        for (size_t i = 0; i < a.size(); ++i) {
+            const C& coeff = a[i];
+            if (coeff == C()) {
+                continue;
+            }
+            C* out = coeffs.data() + i;
+            for (size_t j = 0; j < b.size(); ++j) {
+                coefficient_traits<C>::add_to(out[j], coefficient_traits<C>::mul(coeff, b[j]));
+            }
+        }
+        return coeffs;
+    }
+
+    if constexpr (coefficient_traits<C>::machine_word) {
+        std::vector<uint64_t> wide_a(a.size()), wide_b(square ? 0 : b.size()), wide_out(coeffs.size());
+        for (size_t i = 0; i < a.size(); ++i) {
+            wide_a[i] = static_cast<uint64_t>(static_cast<int64_t>(a[i]));
+        }
+        for (size_t i = 0; i < wide_b.size(); ++i) {
+            wide_b[i] = static_cast<uint64_t>(static_cast<int64_t>(b[i]));
+        }
+        multiply_coefficients(wide_a.data(), wide_a.size(), square ? wide_a.data() : wide_b.data(), b.size(),
+                              wide_out.data(), coefficient_traits<C>::low_32_bits);
+        for (size_t i = 0; i < coeffs.size(); ++i) {
+            coeffs[i] = static_cast<C>(static_cast<int64_t>(wide_out[i]));
+        }
+    } else {
+        multiply_generic(a.data(), a.size(), b.data(), b.size(), coeffs.data());
+    }
+    return coeffs;
+}
+
+} // namespace poly_kernels
@@ -0,0 +1,489 @@
+#include "poly_simd.hpp"
+
+#include <atomic>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define POLY_SIMD_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+// MSVC 无需为单个函数开启指令集
+#define POLY_TARGET_SSE2
+#define POLY_TARGET_AVX2
+#else
+#define POLY_TARGET_SSE2 __attribute__((target("sse2")))
+#define POLY_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#else
+#define POLY_SIMD_X86 0
+#endif
+
+using namespace std;
+
+namespace poly_simd {
+
+// ============================================================================
+// 标量实现 (无符号运算, 回绕结果与补码一致)
+// ============================================================================
+
+static void negate_scalar(const int32_t* src, int32_t* dst, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        dst[i] = static_cast<int32_t>(0u - static_cast<uint32_t>(src[i]));
+    }
+}
+
+static void scale_scalar(const int32_t* src, int32_t factor, int32_t* dst, size_t n) {
+    uint32_t k = static_cast<uint32_t>(factor);
+    for (size_t i = 0; i < n; ++i) {
+        dst[i] = static_cast<int32_t>(static_cast<uint32_t>(src[i]) * k);
+    }
+}
+
+static void scale_add_scalar(const int32_t* src, int32_t factor, int32_t* dst, size_t n) {
+    uint32_t k = static_cast<uint32_t>(factor);
+    for (size_t i = 0; i < n; ++i) {
+        dst[i] = static_cast<int32_t>(static_cast<uint32_t>(dst[i]) + static_cast<uint32_t>(src[i]) * k);
+    }
+}
+
+static void add_scalar(const int32_t* src, int32_t* dst, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        dst[i] = static_cast<int32_t>(static_cast<uint32_t>(dst[i]) + static_cast<uint32_t>(src[i]));
+    }
+}
+
+static void sub_scalar(const int32_t* src, int32_t* dst, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        dst[i] = static_cast<int32_t>(static_cast<uint32_t>(dst[i]) - static_cast<uint32_t>(src[i]));
+    }
+}
+
+static void derivative_scalar(const int32_t* coeffs, const int32_t* exps, int32_t* out_coeffs, int32_t* out_exps,
+                              size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        uint32_t e = static_cast<uint32_t>(exps[i]);
+        out_coeffs[i] = static_cast<int32_t>(static_cast<uint32_t>(coeffs[i]) * e);
+        out_exps[i] = static_cast<int32_t>(e - 1);
+    }
+}
+
+static void derivative_dense_scalar(const int32_t* src, int32_t* dst, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        dst[i] = static_cast<int32_t>(static_cast<uint32_t>(src[i + 1]) * static_cast<uint32_t>(i + 1));
+    }
+}
+
+static size_t count_nonzero_scalar(const int32_t* a, size_t n) {
+    size_t count = 0;
+    for (size_t i = 0; i < n; ++i) {
+        count += a[i] != 0;
+    }
+    return count;
+}
+
+static size_t compact_nonzero_from(int32_t* coeffs, int32_t* exps, size_t read, size_t write, size_t n) {
+    for (; read < n; ++read) {
+        if (coeffs[read] != 0) {
+            coeffs[write] = coeffs[read];
+            exps[write] = exps[read];
+            ++write;
+        }
+    }
+    return write;
+}
+
+// 先跳过不含零的前缀 (无需移动), 从第一个零开始压缩
+static size_t compact_nonzero_scalar(int32_t* coeffs, int32_t* exps, size_t n) {
+    size_t i = 0;
+    while (i < n && coeffs[i] != 0) {
+        ++i;
+    }
+    return compact_nonzero_from(coeffs, exps, i, i, n);
+}
+
+#if POLY_SIMD_X86
+
+// ============================================================================
+// SSE2 实现 (4 路)
+// ============================================================================
+
+// SSE2 没有 32 位低位乘法, 用两次 32x32->64 乘法拼出低 32 位
+POLY_TARGET_SSE2 static inline __m128i mullo_sse2(__m128i a, __m128i b) {
+    __m128i even = _mm_mul_epu32(a, b);
+    __m128i odd = _mm_mul_epu32(_mm_srli_si128(a, 4), _mm_srli_si128(b, 4));
+    return _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)),
+                              _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+}
+
+POLY_TARGET_SSE2 static void negate_sse2(const int32_t* src, int32_t* dst, size_t n) {
+    const __m128i zero = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_sub_epi32(zero, v));
+    }
+    negate_scalar(src + i, dst + i, n - i);
+}
+
+POLY_TARGET_SSE2 static void scale_sse2(const int32_t* src, int32_t factor, int32_t* dst, size_t n) {
+    const __m128i k = _mm_set1_epi32(factor);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), mullo_sse2(v, k));
+    }
+    scale_scalar(src + i, factor, dst + i, n - i);
+}
+
+POLY_TARGET_SSE2 static void scale_add_sse2(const int32_t* src, int32_t factor, int32_t* dst, size_t n) {
+    const __m128i k = _mm_set1_epi32(factor);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_add_epi32(d, mullo_sse2(v, k)));
+    }
+    scale_add_scalar(src + i, factor, dst + i, n - i);
+}
+
+POLY_TARGET_SSE2 static void add_sse2(const int32_t* src, int32_t* dst, size_t n) {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_add_epi32(d, v));
+    }
+    add_scalar(src + i, dst + i, n - i);
+}
+
+POLY_TARGET_SSE2 static void sub_sse2(const int32_t* src, int32_t* dst, size_t n) {
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+        __m128i d = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_sub_epi32(d, v));
+    }
+    sub_scalar(src + i, dst + i, n - i);
+}
+
+POLY_TARGET_SSE2 static void derivative_sse2(const int32_t* coeffs, const int32_t* exps, int32_t* out_coeffs,
+                                             int32_t* out_exps, size_t n) {
+    const __m128i one = _mm_set1_epi32(1);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(coeffs + i));
+        __m128i e = _mm_loadu_si128(reinterpret_cast<const __m128i*>(exps + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out_coeffs + i), mullo_sse2(c, e));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out_exps + i), _mm_sub_epi32(e, one));
+    }
+    derivative_scalar(coeffs + i, exps + i, out_coeffs + i, out_exps + i, n - i);
+}
+
+POLY_TARGET_SSE2 static void derivative_dense_sse2(const int32_t* src, int32_t* dst, size_t n) {
+    const __m128i step = _mm_set1_epi32(4);
+    __m128i index = _mm_setr_epi32(1, 2, 3, 4);
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 1));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), mullo_sse2(v, index));
+        index = _mm_add_epi32(index, step);
+    }
+    for (; i < n; ++i) {
+        dst[i] = static_cast<int32_t>(static_cast<uint32_t>(src[i + 1]) * static_cast<uint32_t>(i + 1));
+    }
+}
+
+// 按 lane 累计零的个数 (比较结果为 -1), 最后横向求和
+POLY_TARGET_SSE2 static size_t count_nonzero_sse2(const int32_t* a, size_t n) {
+    const __m128i zero = _mm_setzero_si128();
+    size_t zeros = 0;
+    size_t i = 0;
+    while (i + 4 <= n) {
+        // 每轮最多累计 2^30 次, 避免 lane 计数溢出
+        size_t end = i + (static_cast<size_t>(1) << 30) * 4 < n ? i + (static_cast<size_t>(1) << 30) * 4 : n;
+        __m128i acc = _mm_setzero_si128();
+        for (; i + 4 <= end; i += 4) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+            acc = _mm_sub_epi32(acc, _mm_cmpeq_epi32(v, zero));
+        }
+        alignas(16) uint32_t lanes[4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(lanes), acc);
+        zeros += static_cast<size_t>(lanes[0]) + lanes[1] + lanes[2] + lanes[3];
+    }
+    return (i - zeros) + count_nonzero_scalar(a + i, n - i);
+}
+
+// SSE2 没有可变重排, 只加速前缀中没有零的整块 (无需移动)
+POLY_TARGET_SSE2 static size_t compact_nonzero_sse2(int32_t* coeffs, int32_t* exps, size_t n) {
+    const __m128i zero = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(coeffs + i));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(v, zero)) != 0) {
+            break;
+        }
+    }
+    return compact_nonzero_from(coeffs, exps, i, i, n);
+}
+
+// ============================================================================
+// AVX2 实现 (8 路)
+// ============================================================================
+
+POLY_TARGET_AVX2 static void negate_avx2(const int32_t* src, int32_t* dst, size_t n) {
+    const __m256i zero = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_sub_epi32(zero, v));
+    }
+    negate_scalar(src + i, dst + i, n - i);
+}
+
+POLY_TARGET_AVX2 static void scale_avx2(const int32_t* src, int32_t factor, int32_t* dst, size_t n) {
+    const __m256i k = _mm256_set1_epi32(factor);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_mullo_epi32(v, k));
+    }
+    scale_scalar(src + i, factor, dst + i, n - i);
+}
+
+POLY_TARGET_AVX2 static void scale_add_avx2(const int32_t* src, int32_t factor, int32_t* dst, size_t n) {
+    const __m256i k = _mm256_set1_epi32(factor);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_add_epi32(d, _mm256_mullo_epi32(v, k)));
+    }
+    scale_add_scalar(src + i, factor, dst + i, n - i);
+}
+
+POLY_TARGET_AVX2 static void add_avx2(const int32_t* src, int32_t* dst, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_add_epi32(d, v));
+    }
+    add_scalar(src + i, dst + i, n - i);
+}
+
+POLY_TARGET_AVX2 static void sub_avx2(const int32_t* src, int32_t* dst, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+        __m256i d = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_sub_epi32(d, v));
+    }
+    sub_scalar(src + i, dst + i, n - i);
+}
+
+POLY_TARGET_AVX2 static void derivative_avx2(const int32_t* coeffs, const int32_t* exps, int32_t* out_coeffs,
+                                             int32_t* out_exps, size_t n) {
+    const __m256i one = _mm256_set1_epi32(1);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(coeffs + i));
+        __m256i e = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(exps + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out_coeffs + i), _mm256_mullo_epi32(c, e));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out_exps + i), _mm256_sub_epi32(e, one));
+    }
+    derivative_scalar(coeffs + i, exps + i, out_coeffs + i, out_exps + i, n - i);
+}
+
+POLY_TARGET_AVX2 static void derivative_dense_avx2(const int32_t* src, int32_t* dst, size_t n) {
+    const __m256i step = _mm256_set1_epi32(8);
+    __m256i index = _mm256_setr_epi32(1, 2, 3, 4, 5, 6, 7, 8);
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i + 1));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_mullo_epi32(v, index));
+        index = _mm256_add_epi32(index, step);
+    }
+    for (; i < n; ++i) {
+        dst[i] = static_cast<int32_t>(static_cast<uint32_t>(src[i + 1]) * static_cast<uint32_t>(i + 1));
+    }
+}
+
+POLY_TARGET_AVX2 static size_t count_nonzero_avx2(const int32_t* a, size_t n) {
+    const __m256i zero = _mm256_setzero_si256();
+    size_t zeros = 0;
+    size_t i = 0;
+    while (i + 8 <= n) {
+        size_t end = i + (static_cast<size_t>(1) << 30) * 8 < n ? i + (static_cast<size_t>(1) << 30) * 8 : n;
+        __m256i acc = _mm256_setzero_si256();
+        for (; i + 8 <= end; i += 8) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(a + i));
+            acc = _mm256_sub_epi32(acc, _mm256_cmpeq_epi32(v, zero));
+        }
+        alignas(32) uint32_t lanes[8];
+        _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), acc);
+        for (int l = 0; l < 8; ++l) {
+            zeros += lanes[l];
+        }
+    }
+    return (i - zeros) + count_nonzero_scalar(a + i, n - i);
+}
+
+// 压缩重排表: 对 8 位保留掩码, 给出把保留的 lane 依次移到前面的下标
+struct CompactTable {
+    alignas(32) int32_t index[256][8];
+    uint8_t count[256];
+
+    CompactTable() {
+        for (int mask = 0; mask < 256; ++mask) {
+            int k = 0;
+            for (int l = 0; l < 8; ++l) {
+                if (mask & (1 << l)) {
+                    index[mask][k++] = l;
+                }
+            }
+            count[mask] = static_cast<uint8_t>(k);
+            for (; k < 8; ++k) {
+                index[mask][k] = 0;
+            }
+        }
+    }
+};
+
+static const CompactTable& compact_table() {
+    static const CompactTable table;
+    return table;
+}
+
+// 每 8 项按非零掩码查表重排后整块写出, 写指针不超过读指针, 原地写入只会覆盖已读取的数据
+POLY_TARGET_AVX2 static size_t compact_nonzero_avx2(int32_t* coeffs, int32_t* exps, size_t n) {
+    const CompactTable& table = compact_table();
+    const __m256i zero = _mm256_setzero_si256();
+    size_t write = 0;
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(coeffs + i));
+        __m256i e = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(exps + i));
+        int zero_mask = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(c, zero)));
+        int keep = ~zero_mask & 0xff;
+        if (keep == 0xff && write == i) {
+            write += 8;
+            continue;
+        }
+        __m256i perm = _mm256_load_si256(reinterpret_cast<const __m256i*>(table.index[keep]));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(coeffs + write), _mm256_permutevar8x32_epi32(c, perm));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(exps + write), _mm256_permutevar8x32_epi32(e, perm));
+        write += table.count[keep];
+    }
+    return compact_nonzero_from(coeffs, exps, i, write, n);
+}
+
+#endif // POLY_SIMD_X86
+
+// ============================================================================
+// 运行时分派
+// ============================================================================
+
+static SimdLevel detect_level() {
+#if POLY_SIMD_X86
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    int max_leaf = info[0];
+    __cpuid(info, 1);
+    bool sse2 = (info[3] & (1 << 26)) != 0;
+    bool osxsave = (info[2] & (1 << 27)) != 0;
+    bool avx = (info[2] & (1 << 28)) != 0;
+    bool avx2 = false;
+    // 还要确认操作系统保存 YMM 寄存器
+    if (max_leaf >= 7 && osxsave && avx && (_xgetbv(0) & 6) == 6) {
+        __cpuidex(info, 7, 0);
+        avx2 = (info[1] & (1 << 5)) != 0;
+    }
+#else
+    __builtin_cpu_init();
+    bool sse2 = __builtin_cpu_supports("sse2");
+    bool avx2 = __builtin_cpu_supports("avx2");
+#endif
+    if (avx2) {
+        return SIMD_AVX2;
+    }
+    if (sse2) {
+        return SIMD_SSE2;
+    }
+#endif
+    return SIMD_SCALAR;
+}
+
+static SimdLevel supported_level() {
+    static const SimdLevel level = detect_level();
+    return level;
+}
+
+static atomic<int>& active_level() {
+    static atomic<int> level(supported_level());
+    return level;
+}
+
+SimdLevel simd_level() {
+    return static_cast<SimdLevel>(active_level().load(memory_order_relaxed));
+}
+
+SimdLevel set_simd_level(SimdLevel level) {
+    SimdLevel effective = level < supported_level() ? level : supported_level();
+    active_level().store(effective, memory_order_relaxed);
+    return effective;
+}
+
+#if POLY_SIMD_X86
+#define POLY_SIMD_DISPATCH(name, ...)                  \
+    switch (simd_level()) {                             \
+        case SIMD_AVX2:                                 \
+            return name##_avx2(__VA_ARGS__);            \
+        case SIMD_SSE2:                                 \
+            return name##_sse2(__VA_ARGS__);            \
+        default:                                        \
+            return name##_scalar(__VA_ARGS__);          \
+    }
+#else
+#define POLY_SIMD_DISPATCH(name, ...) return name##_scalar(__VA_ARGS__);
+#endif
+
+void negate(const int32_t* src, int32_t* dst, size_t n) {
+    POLY_SIMD_DISPATCH(negate, src, dst, n)
+}
+
+void scale(const int32_t* src, int32_t factor, int32_t* dst, size_t n) {
+    POLY_SIMD_DISPATCH(scale, src, factor, dst, n)
+}
+
+void scale_add(const int32_t* src, int32_t factor, int32_t* dst, size_t n) {
+    POLY_SIMD_DISPATCH(scale_add, src, factor, dst, n)
+}
+
+void add(const int32_t* src, int32_t* dst, size_t n) {
+    POLY_SIMD_DISPATCH(add, src, dst, n)
+}
+
+void sub(const int32_t* src, int32_t* dst, size_t n) {
+    POLY_SIMD_DISPATCH(sub, src, dst, n)
+}
+
+void derivative(const int32_t* coeffs, const int32_t* exps, int32_t* out_coeffs, int32_t* out_exps, size_t n) {
+    POLY_SIMD_DISPATCH(derivative, coeffs, exps, out_coeffs, out_exps, n)
+}
+
+void derivative_dense(const int32_t* src, int32_t* dst, size_t n) {
+    POLY_SIMD_DISPATCH(derivative_dense, src, dst, n)
+}
+
+size_t count_nonzero(const int32_t* a, size_t n) {
+    POLY_SIMD_DISPATCH(count_nonzero, a, n)
+}
+
+size_t compact_nonzero(int32_t* coeffs, int32_t* exps, size_t n) {
+    POLY_SIMD_DISPATCH(compact_nonzero, coeffs, exps, n)
+}
+
+#undef POLY_SIMD_DISPATCH
+
+} // namespace poly_simd
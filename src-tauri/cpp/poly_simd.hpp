@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// 32 位系数数组的向量化内核
+// 运算按补码回绕 (与 int 乘加溢出的结果一致); 运行时检测 CPU, 依次选择 AVX2 / SSE2 / 标量实现,
+// 非 x86 平台只有标量实现
+namespace poly_simd {
+
+enum SimdLevel {
+    SIMD_SCALAR = 0,
+    SIMD_SSE2 = 1,
+    SIMD_AVX2 = 2,
+};
+
+// 当前使用的指令集
+SimdLevel simd_level();
+
+// 限制使用的指令集 (不超过 CPU 支持的级别), 返回实际生效的级别, 用于测试和基准对比
+SimdLevel set_simd_level(SimdLevel level);
+
+// dst[i] = -src[i] (允许 dst == src)
+void negate(const int32_t* src, int32_t* dst, size_t n);
+
+// dst[i] = factor * src[i] (允许 dst == src)
+void scale(const int32_t* src, int32_t factor, int32_t* dst, size_t n);
+
+// dst[i] += factor * src[i]
+void scale_add(const int32_t* src, int32_t factor, int32_t* dst, size_t n);
+
+// dst[i] += src[i]
+void add(const int32_t* src, int32_t* dst, size_t n);
+
+// dst[i] -= src[i]
+void sub(const int32_t* src, int32_t* dst, size_t n);
+
+// 稀疏求导: out_coeffs[i] = coeffs[i] * exps[i], out_exps[i] = exps[i] - 1 (允许原地)
+void derivative(const int32_t* coeffs, const int32_t* exps, int32_t* out_coeffs, int32_t* out_exps, size_t n);
+
+// 稠密求导: dst[i] = src[i + 1] * (i + 1), i < n
+void derivative_dense(const int32_t* src, int32_t* dst, size_t n);
+
+// 非零元素个数
+size_t count_nonzero(const int32_t* a, size_t n);
+
+// 原地移除系数为零的项 (系数与指数同步移动, 保持顺序), 返回剩余项数
+size_t compact_nonzero(int32_t* coeffs, int32_t* exps, size_t n);
+
+} // namespace poly_simd
@@ -1,10 +1,18 @@
 #include "polynomial.hpp"
+#include "poly_multiply.hpp"
+#include "multipoint.hpp"
+#include "poly_simd.hpp"
+#include "poly_arena.hpp"
 #include <iostream>
 #include <cctype>
 #include "stack.hpp"
 #include <stdexcept>
 #include <algorithm>
 #include <cstring>
+#include <atomic>
+#include <type_traits>
+#include <memory>
+#include <limits>
 
 using namespace std;
 
@@ -12,648 +20,3067 @@ using namespace std;
 // Term类实现
 // ============================================================================
 
-Term::Term(int coefficient, int exponent)
+template <typename C, typename E>
+BasicTerm<C, E>::BasicTerm(const C& coefficient, E exponent)
     : coefficient_(coefficient), exponent_(exponent) {
 }
 
 // 项转换为字符串表示
-string Term::to_string() const {
-    return "(" + std::to_string(coefficient_) + "x^" + std::to_string(exponent_) + ")";
+template <typename C, typename E>
+string BasicTerm<C, E>::to_string() const {
+    return "(" + coefficient_traits<C>::to_string(coefficient_) + "x^" +
+           coefficient_traits<E>::to_string(exponent_) + ")";
 }
 
 // ============================================================================
 // Polynomial类实现
 // ============================================================================
 
+// 稠密存储阈值: 项数不少于 DENSE_MIN_TERMS 且填充率 cnt / (deg + 1) >= 1/2 时转为稠密
+// (稠密每个指数存一个系数, 稀疏每项存系数和指数, 填充率 1/2 时内存大致相同);
+// 填充率低于 1/4 或项数过少时转回稀疏, 两个阈值之间保持不变, 避免反复切换
+static const int DENSE_MIN_TERMS = 16;
+
+// sign = 1 返回 coeff, sign = -1 返回 -coeff
+template <typename C>
+static C apply_sign(const C& coeff, int sign) {
+    return sign > 0 ? coeff : coefficient_traits<C>::negate(coeff);
+}
+
+// acc += sign * value
+template <typename C>
+static void accumulate_signed(C& acc, const C& value, int sign) {
+    if (sign > 0) {
+        coefficient_traits<C>::add_to(acc, value);
+    } else {
+        coefficient_traits<C>::subtract_from(acc, value);
+    }
+}
+
+// 32 位整数系数和指数的多项式使用 poly_simd 中的向量化内核, 其他类型使用通用循环
+template <typename C, typename E>
+struct simd_terms : integral_constant<bool, is_same<C, int32_t>::value && is_same<E, int32_t>::value> {
+};
+
 // 构造函数
-Polynomial::Polynomial(size_t capacity)
-    : capacity_(capacity), cnt_(0) {
-    terms_ = new Term[capacity_];
+template <typename C, typename E>
+BasicPolynomial<C, E>::BasicPolynomial(size_t capacity)
+    : coeffs_(inline_coeffs_), exps_(inline_exps_), cnt_(0), capacity_(INLINE_TERMS), is_dense_(false), arena_block_(false) {
+    allocate_terms(capacity);
 }
 
 // 从字符串构造多项式
-Polynomial::Polynomial(const string& input, size_t capacity)
-    : capacity_(capacity), cnt_(0) {
-    terms_ = new Term[capacity_];
+template <typename C, typename E>
+BasicPolynomial<C, E>::BasicPolynomial(const string& input, size_t capacity)
+    : coeffs_(inline_coeffs_), exps_(inline_exps_), cnt_(0), capacity_(INLINE_TERMS), is_dense_(false), arena_block_(false) {
+    allocate_terms(capacity);
     parse_from_string(input);
 }
 
 // 从项数组构造多项式
-Polynomial::Polynomial(const Term* terms, int count, size_t capacity)
-    : capacity_(capacity > count ? capacity : count * 2), cnt_(count) {
-    terms_ = new Term[capacity_];
+template <typename C, typename E>
+BasicPolynomial<C, E>::BasicPolynomial(const Term* terms, int count, size_t capacity)
+    : coeffs_(inline_coeffs_), exps_(inline_exps_), cnt_(count), capacity_(INLINE_TERMS), is_dense_(false), arena_block_(false) {
+    allocate_terms(capacity > count ? capacity : count * 2);
     for (int i = 0; i < cnt_; ++i) {
-        terms_[i] = terms[i];
+        coeffs_[i] = terms[i].get_coefficient();
+        exps_[i] = terms[i].get_exponent();
     }
     sort_terms();
     combine_like_terms();
     remove_zero_terms();
+    update_representation();
 }
 
-// 复制构造函数
-Polynomial::Polynomial(const Polynomial& other)
-    : capacity_(other.capacity_), cnt_(other.cnt_) {
-    terms_ = new Term[capacity_];
-    for (int i = 0; i < cnt_; ++i) {
-        terms_[i] = other.terms_[i];
-    }
+// 复制构造函数: 共享 other 的堆数组, 少量项时直接复制到内联存储中
+template <typename C, typename E>
+BasicPolynomial<C, E>::BasicPolynomial(const BasicPolynomial& other)
+    : coeffs_(inline_coeffs_), exps_(inline_exps_), cnt_(0), capacity_(INLINE_TERMS), is_dense_(false), arena_block_(false) {
+    copy_from(other);
 }
 
 // 移动构造函数
-Polynomial::Polynomial(Polynomial&& other) noexcept
-    : terms_(other.terms_), cnt_(other.cnt_), capacity_(other.capacity_) {
-    other.terms_ = nullptr;
-    other.cnt_ = 0;
-    other.capacity_ = 0;
+template <typename C, typename E>
+BasicPolynomial<C, E>::BasicPolynomial(BasicPolynomial&& other) noexcept
+    : coeffs_(inline_coeffs_), exps_(inline_exps_), cnt_(0), capacity_(INLINE_TERMS), is_dense_(false), arena_block_(false) {
+    steal_from(other);
 }
 
-Polynomial& Polynomial::operator=(const Polynomial& other) {
+template <typename C, typename E>
+BasicPolynomial<C, E>& BasicPolynomial<C, E>::operator=(const BasicPolynomial& other) {
     if (this != &other) {
-        delete[] terms_;
-        capacity_ = other.capacity_;
-        cnt_ = other.cnt_;
-        terms_ = new Term[capacity_];
-        for (int i = 0; i < cnt_; ++i) {
-            terms_[i] = other.terms_[i];
-        }
+        release_terms();
+        copy_from(other);
     }
     return *this;
 }
 
 // 移动赋值运算符
-Polynomial& Polynomial::operator=(Polynomial&& other) noexcept {
+template <typename C, typename E>
+BasicPolynomial<C, E>& BasicPolynomial<C, E>::operator=(BasicPolynomial&& other) noexcept {
     if (this != &other) {
-        delete[] terms_;
-        terms_ = other.terms_;
-        cnt_ = other.cnt_;
-        capacity_ = other.capacity_;
-        other.terms_ = nullptr;
-        other.cnt_ = 0;
-        other.capacity_ = 0;
+        release_terms();
+        steal_from(other);
     }
     return *this;
 }
 
 
-Polynomial::~Polynomial() {
-    delete[] terms_;
+template <typename C, typename E>
+BasicPolynomial<C, E>::~BasicPolynomial() {
+    release_terms();
 }
 
-// 扩容
-void Polynomial::resize_if_needed() {
-    if (cnt_ == capacity_) {
-        size_t new_capacity = capacity_ * 2;
-        Term* new_terms = new Term[new_capacity];
+// 接管 other 的内容 (要求本对象已释放为内联存储): 堆上的数组直接转移指针,
+// 内联存储中的项逐个移动; other 变为空的稀疏多项式
+template <typename C, typename E>
+void BasicPolynomial<C, E>::steal_from(BasicPolynomial& other) noexcept {
+    if (other.uses_inline_terms()) {
+        int inline_count = other.is_dense_ ? 0 : other.cnt_;
+        for (int i = 0; i < inline_count; ++i) {
+            inline_coeffs_[i] = std::move(other.inline_coeffs_[i]);
+            inline_exps_[i] = other.inline_exps_[i];
+        }
+    } else {
+        coeffs_ = other.coeffs_;
+        exps_ = other.exps_;
+        capacity_ = other.capacity_;
+        arena_block_ = other.arena_block_;
+        other.coeffs_ = other.inline_coeffs_;
+        other.exps_ = other.inline_exps_;
+        other.capacity_ = INLINE_TERMS;
+        other.arena_block_ = false;
+    }
+    cnt_ = other.cnt_;
+    dense_ = std::move(other.dense_);
+    is_dense_ = other.is_dense_;
+    other.cnt_ = 0;
+    other.dense_.release();
+    other.is_dense_ = false;
+}
+
+// 堆上数组块的头部: 引用计数, 为 0 时释放整块
+// 分配器中的数组块没有头部, 也不共享 (分配器在求值结束后整体回收, 不能被求值之外的多项式引用)
+struct TermBlockHeader {
+    atomic<size_t> refs;
+};
+
+// 数组块的对齐和头部大小 (头部之后紧接系数数组)
+template <typename C, typename E>
+static constexpr size_t term_block_alignment() {
+    return max(max(alignof(C), alignof(E)), alignof(TermBlockHeader));
+}
+
+template <typename C, typename E>
+static constexpr size_t term_block_header_size() {
+    return (sizeof(TermBlockHeader) + term_block_alignment<C, E>() - 1) / term_block_alignment<C, E>() *
+           term_block_alignment<C, E>();
+}
+
+// 堆上数组块的头部
+template <typename C, typename E>
+static TermBlockHeader* term_block_header(C* coeffs) {
+    return reinterpret_cast<TermBlockHeader*>(reinterpret_cast<char*>(coeffs) - term_block_header_size<C, E>());
+}
+
+// 指数数组在内存块中的偏移 (系数数组在前, 按指数类型对齐)
+template <typename C, typename E>
+static size_t exps_offset(size_t capacity) {
+    return (capacity * sizeof(C) + alignof(E) - 1) / alignof(E) * alignof(E);
+}
+
+// 分配容量为 capacity 的系数和指数数组: 两者放在同一块内存中, 每次扩容只申请一次
+// (分成两次申请时, 大数组各自走 mmap, 每次运算都要重新缺页)
+// 当前线程设置了 PolynomialArena 时从中分配, 返回 true; 否则从堆上分配 (带引用计数为 1 的头部), 返回 false
+template <typename C, typename E>
+static bool allocate_block(size_t capacity, C*& coeffs, E*& exps) {
+    size_t offset = exps_offset<C, E>(capacity);
+    size_t bytes = offset + capacity * sizeof(E);
+    PolynomialArena* arena = PolynomialArena::current();
+    char* block;
+    if (arena != nullptr) {
+        block = static_cast<char*>(arena->allocate(bytes, max(alignof(C), alignof(E))));
+    } else {
+        char* raw = static_cast<char*>(::operator new(term_block_header_size<C, E>() + bytes));
+        new (raw) TermBlockHeader{{1}};
+        block = raw + term_block_header_size<C, E>();
+    }
+    coeffs = reinterpret_cast<C*>(block);
+    exps = reinterpret_cast<E*>(block + offset);
+    uninitialized_default_construct_n(coeffs, capacity);
+    uninitialized_default_construct_n(exps, capacity);
+    return arena != nullptr;
+}
+
+// 放弃对 allocate_block 分配的数组的引用: 堆上的块引用计数减到 0 时析构并释放,
+// 分配器中的块只析构数组 (内存由分配器整体回收)
+template <typename C, typename E>
+static void free_block(C* coeffs, E* exps, size_t capacity, bool from_arena) {
+    if (from_arena) {
+        destroy_n(coeffs, capacity);
+        destroy_n(exps, capacity);
+        return;
+    }
+    TermBlockHeader* header = term_block_header<C, E>(coeffs);
+    if (header->refs.fetch_sub(1, memory_order_acq_rel) == 1) {
+        destroy_n(coeffs, capacity);
+        destroy_n(exps, capacity);
+        header->~TermBlockHeader();
+        ::operator delete(static_cast<void*>(header));
+    }
+}
+
+// 准备容量至少为 capacity 的数组 (要求当前为内联存储), 不超过 INLINE_TERMS 时不分配
+template <typename C, typename E>
+void BasicPolynomial<C, E>::allocate_terms(size_t capacity) {
+    if (capacity > INLINE_TERMS) {
+        arena_block_ = allocate_block(capacity, coeffs_, exps_);
+        capacity_ = capacity;
+    }
+}
+
+// 释放堆上的数组, 回到内联存储
+template <typename C, typename E>
+void BasicPolynomial<C, E>::release_terms() {
+    if (!uses_inline_terms()) {
+        free_block(coeffs_, exps_, capacity_, arena_block_);
+        coeffs_ = inline_coeffs_;
+        exps_ = inline_exps_;
+        capacity_ = INLINE_TERMS;
+        arena_block_ = false;
+    }
+}
+
+// 复制 other 的内容 (要求本对象已释放为内联存储)
+// 稀疏数组在堆上时共享 other 的数组块, 只增加引用计数; 在内联存储或分配器中时按项数复制
+template <typename C, typename E>
+void BasicPolynomial<C, E>::copy_from(const BasicPolynomial& other) {
+    cnt_ = other.cnt_;
+    dense_ = other.dense_;
+    is_dense_ = other.is_dense_;
+    if (is_dense_) {
+        return;
+    }
+    if (!other.uses_inline_terms() && !other.arena_block_) {
+        term_block_header<C, E>(other.coeffs_)->refs.fetch_add(1, memory_order_relaxed);
+        coeffs_ = other.coeffs_;
+        exps_ = other.exps_;
+        capacity_ = other.capacity_;
+        return;
+    }
+    allocate_terms(cnt_);
+    copy(other.coeffs_, other.coeffs_ + cnt_, coeffs_);
+    copy(other.exps_, other.exps_ + cnt_, exps_);
+}
+
+// 稀疏数组是否与其他多项式共享
+template <typename C, typename E>
+bool BasicPolynomial<C, E>::shares_terms() const {
+    return !uses_inline_terms() && !arena_block_ &&
+           term_block_header<C, E>(coeffs_)->refs.load(memory_order_acquire) > 1;
+}
+
+// 被共享时换成同样容量的独占副本
+template <typename C, typename E>
+void BasicPolynomial<C, E>::make_terms_unique() {
+    if (shares_terms()) {
+        reallocate(capacity_);
+    }
+}
+
+// 换到容量为 new_capacity 的新数组, 保留已有项 (原数组被共享时复制, 否则移动)
+template <typename C, typename E>
+void BasicPolynomial<C, E>::reallocate(size_t new_capacity) {
+    C* new_coeffs;
+    E* new_exps;
+    bool from_arena = allocate_block(new_capacity, new_coeffs, new_exps);
+    if (shares_terms()) {
+        copy(coeffs_, coeffs_ + cnt_, new_coeffs);
+    } else {
         for (int i = 0; i < cnt_; ++i) {
-            new_terms[i] = terms_[i];
+            new_coeffs[i] = std::move(coeffs_[i]);
+        }
+    }
+    copy(exps_, exps_ + cnt_, new_exps);
+    release_terms();
+    coeffs_ = new_coeffs;
+    exps_ = new_exps;
+    capacity_ = new_capacity;
+    arena_block_ = from_arena;
+}
+
+// 扩容 (同时保证数组为独占, 之后可以直接写入)
+template <typename C, typename E>
+void BasicPolynomial<C, E>::resize_if_needed() {
+    if (cnt_ == capacity_) {
+        reallocate(capacity_ * 2);
+    } else {
+        make_terms_unique();
+    }
+}
+
+// 预留容量 (同时保证数组为独占, 之后可以直接写入)
+template <typename C, typename E>
+void BasicPolynomial<C, E>::reserve(size_t min_capacity) {
+    if (capacity_ >= min_capacity) {
+        make_terms_unique();
+        return;
+    }
+    reallocate(capacity_ * 2 > min_capacity ? capacity_ * 2 : min_capacity);
+}
+
+// 对 keys 按高 32 位做稳定的基数排序 (低 32 位随之移动), 每趟 11 位, 所有键该段相同的趟跳过
+static void radix_sort_high(vector<uint64_t>& keys) {
+    vector<uint64_t> buffer(keys.size());
+    size_t counts[2048];
+    for (int shift = 32; shift < 64; shift += 11) {
+        fill(counts, counts + 2048, size_t(0));
+        for (uint64_t key : keys) {
+            ++counts[(key >> shift) & 2047];
         }
-        delete[] terms_;
-        terms_ = new_terms;
-        capacity_ = new_capacity;
+        if (counts[(keys[0] >> shift) & 2047] == keys.size()) {
+            continue;
+        }
+        size_t sum = 0;
+        for (size_t& bucket : counts) {
+            size_t start = sum;
+            sum += bucket;
+            bucket = start;
+        }
+        for (uint64_t key : keys) {
+            buffer[counts[(key >> shift) & 2047]++] = key;
+        }
+        keys.swap(buffer);
     }
 }
 
-// 按照项的指数冒泡排序
-void Polynomial::sort_terms() {
+// 32 位以内的整数指数与排序键互相转换: 有符号映射到无符号后取反, 键升序即指数降序
+template <typename E>
+static uint32_t exponent_key(E exp) {
+    return ~(static_cast<uint32_t>(static_cast<int32_t>(exp)) ^ 0x80000000u);
+}
+
+template <typename E>
+static E exponent_from_key(uint32_t key) {
+    return static_cast<E>(static_cast<int32_t>(~key ^ 0x80000000u));
+}
+
+// 按指数降序稳定排序: 已有序时直接返回, 项数少时插入排序
+// 32 位以内的整数指数用基数排序, 键的低 32 位放系数 (32 位系数) 或原下标 (之后按下标整体重排一次);
+// 其他指数类型对下标 stable_sort 后重排
+template <typename C, typename E>
+void BasicPolynomial<C, E>::sort_terms() {
+    if (is_sorted(exps_, exps_ + cnt_, greater<E>())) {
+        return;
+    }
+
+    if (cnt_ <= 32) {
+        for (int i = 1; i < cnt_; ++i) {
+            C coeff = std::move(coeffs_[i]);
+            E exp = exps_[i];
+            int j = i;
+            for (; j > 0 && exps_[j - 1] < exp; --j) {
+                coeffs_[j] = std::move(coeffs_[j - 1]);
+                exps_[j] = exps_[j - 1];
+            }
+            coeffs_[j] = std::move(coeff);
+            exps_[j] = exp;
+        }
+        return;
+    }
 
-    for (int i = 0; i < cnt_ - 1; ++i) {
-        for (int j = 0; j < cnt_ - i - 1; ++j) {
-            if (terms_[j].get_exponent() < terms_[j + 1].get_exponent()) {
-                Term temp = terms_[j];
-                terms_[j] = terms_[j + 1];
-                terms_[j + 1] = temp;
+    vector<uint32_t> order(cnt_);
+    if constexpr (is_integral<E>::value && sizeof(E) <= sizeof(uint32_t)) {
+        vector<uint64_t> keys(cnt_);
+        if constexpr (is_trivially_copyable<C>::value && sizeof(C) == sizeof(uint32_t)) {
+            for (int i = 0; i < cnt_; ++i) {
+                uint32_t bits;
+                memcpy(&bits, &coeffs_[i], sizeof(bits));
+                keys[i] = static_cast<uint64_t>(exponent_key(exps_[i])) << 32 | bits;
             }
+            radix_sort_high(keys);
+            for (int i = 0; i < cnt_; ++i) {
+                uint32_t bits = static_cast<uint32_t>(keys[i]);
+                memcpy(static_cast<void*>(&coeffs_[i]), &bits, sizeof(bits));
+                exps_[i] = exponent_from_key<E>(static_cast<uint32_t>(keys[i] >> 32));
+            }
+            return;
+        }
+        for (int i = 0; i < cnt_; ++i) {
+            keys[i] = static_cast<uint64_t>(exponent_key(exps_[i])) << 32 | static_cast<uint32_t>(i);
+        }
+        radix_sort_high(keys);
+        for (int i = 0; i < cnt_; ++i) {
+            order[i] = static_cast<uint32_t>(keys[i]);
         }
+    } else {
+        for (int i = 0; i < cnt_; ++i) {
+            order[i] = static_cast<uint32_t>(i);
+        }
+        const E* exps = exps_;
+        stable_sort(order.begin(), order.end(), [exps](uint32_t a, uint32_t b) { return exps[a] > exps[b]; });
+    }
+
+    vector<C> coeffs(cnt_);
+    vector<E> exps(cnt_);
+    for (int i = 0; i < cnt_; ++i) {
+        coeffs[i] = std::move(coeffs_[order[i]]);
+        exps[i] = exps_[order[i]];
     }
+    std::move(coeffs.begin(), coeffs.end(), coeffs_);
+    copy(exps.begin(), exps.end(), exps_);
 }
 
 // 合并同类项
-void Polynomial::combine_like_terms() {
+template <typename C, typename E>
+void BasicPolynomial<C, E>::combine_like_terms() {
     if (cnt_ == 0) return;
 
     int write_idx = 0;
     for (int read_idx = 1; read_idx < cnt_; ++read_idx) {
-        if (terms_[write_idx].get_exponent() == terms_[read_idx].get_exponent()) {
-            int new_coeff = terms_[write_idx].get_coefficient() + terms_[read_idx].get_coefficient();
-            terms_[write_idx].set_coefficient(new_coeff);
+        if (exps_[write_idx] == exps_[read_idx]) {
+            coefficient_traits<C>::add_to(coeffs_[write_idx], coeffs_[read_idx]);
         } else {
             ++write_idx;
-            terms_[write_idx] = terms_[read_idx];
+            coeffs_[write_idx] = coeffs_[read_idx];
+            exps_[write_idx] = exps_[read_idx];
         }
     }
     cnt_ = write_idx + 1;
 }
 
 // 移除系数为零的项
-void Polynomial::remove_zero_terms() {
+template <typename C, typename E>
+void BasicPolynomial<C, E>::remove_zero_terms() {
+    if constexpr (simd_terms<C, E>::value) {
+        cnt_ = static_cast<int>(poly_simd::compact_nonzero(coeffs_, exps_, cnt_));
+        return;
+    }
     int write_idx = 0;
     for (int read_idx = 0; read_idx < cnt_; ++read_idx) {
-        if (terms_[read_idx].get_coefficient() != 0) {
-            terms_[write_idx] = terms_[read_idx];
+        if (coeffs_[read_idx] != C()) {
+            coeffs_[write_idx] = coeffs_[read_idx];
+            exps_[write_idx] = exps_[read_idx];
             ++write_idx;
         }
     }
     cnt_ = write_idx;
 }
 
+// 最高指数
+template <typename C, typename E>
+E BasicPolynomial<C, E>::max_exponent() const {
+    return is_dense_ ? static_cast<E>(dense_.size()) - 1 : exps_[0];
+}
+
+// 最低指数
+template <typename C, typename E>
+E BasicPolynomial<C, E>::min_exponent() const {
+    if (is_dense_) {
+        E e = 0;
+        while (dense_[e] == C()) {
+            ++e;
+        }
+        return e;
+    }
+    return exps_[cnt_ - 1];
+}
+
+// 两个多项式的和是否适合稠密计算: 指数均非负, 且结果数组长度不超过两倍总项数
+template <typename C, typename E>
+bool BasicPolynomial<C, E>::fits_dense_with(const BasicPolynomial& other) const {
+    if (cnt_ == 0 || other.cnt_ == 0) {
+        return false;
+    }
+    if (min_exponent() < 0 || other.min_exponent() < 0) {
+        return false;
+    }
+    long long len = static_cast<long long>(max(max_exponent(), other.max_exponent())) + 1;
+    return len <= 2LL * (static_cast<long long>(cnt_) + other.cnt_);
+}
+
+// 稀疏 -> 稠密 (要求所有指数非负)
+template <typename C, typename E>
+void BasicPolynomial<C, E>::to_dense() {
+    if (is_dense_) {
+        return;
+    }
+    vector<C> coeffs(cnt_ > 0 ? static_cast<size_t>(exps_[0]) + 1 : 0, C());
+    for (int i = 0; i < cnt_; ++i) {
+        coeffs[exps_[i]] = coeffs_[i];
+    }
+    dense_.assign(std::move(coeffs));
+    release_terms();
+    is_dense_ = cnt_ > 0;
+}
+
+// 稠密 -> 稀疏
+template <typename C, typename E>
+void BasicPolynomial<C, E>::to_sparse() {
+    if (!is_dense_) {
+        return;
+    }
+    release_terms();
+    allocate_terms(cnt_);
+    int w = 0;
+    for (E e = static_cast<E>(dense_.size()) - 1; e >= 0; --e) {
+        if (dense_[e] != C()) {
+            coeffs_[w] = dense_[e];
+            exps_[w] = e;
+            ++w;
+        }
+    }
+    cnt_ = w;
+    dense_.release();
+    is_dense_ = false;
+}
+
+template <typename C, typename E>
+BasicPolynomial<C, E> BasicPolynomial<C, E>::sparse_copy() const {
+    BasicPolynomial copy(*this);
+    copy.to_sparse();
+    return copy;
+}
+
+// 整理稠密数组: 去掉高位零, 重新计数; 全为零时退回空的稀疏多项式
+template <typename C, typename E>
+void BasicPolynomial<C, E>::normalize_dense() {
+    while (!dense_.empty() && dense_.back() == C()) {
+        dense_.mutate().pop_back();
+    }
+    if constexpr (simd_terms<C, E>::value) {
+        cnt_ = static_cast<int>(poly_simd::count_nonzero(dense_.data(), dense_.size()));
+    } else {
+        cnt_ = 0;
+        for (size_t e = 0; e < dense_.size(); ++e) {
+            if (dense_[e] != C()) {
+                ++cnt_;
+            }
+        }
+    }
+    if (cnt_ == 0) {
+        dense_.release();
+        is_dense_ = false;
+    }
+}
+
+// 根据填充率选择存储方式
+template <typename C, typename E>
+void BasicPolynomial<C, E>::update_representation() {
+    if (is_dense_) {
+        if (cnt_ < DENSE_MIN_TERMS / 2 || static_cast<size_t>(cnt_) * 4 < dense_.size()) {
+            to_sparse();
+        }
+    } else if (cnt_ >= DENSE_MIN_TERMS && exps_[cnt_ - 1] >= 0 &&
+               static_cast<long long>(exps_[0]) + 1 <= 2LL * cnt_) {
+        to_dense();
+    }
+}
+
+template <typename C, typename E>
+BasicPolynomial<C, E> BasicPolynomial<C, E>::from_dense(vector<C>&& coeffs) {
+    BasicPolynomial result(0);
+    result.dense_.assign(std::move(coeffs));
+    result.is_dense_ = true;
+    result.normalize_dense();
+    result.update_representation();
+    return result;
+}
+
 // 添加项
-void Polynomial::add_term(const Term& term) {
+template <typename C, typename E>
+void BasicPolynomial<C, E>::add_term(const Term& term) {
+    if (is_dense_) {
+        E exp = term.get_exponent();
+        if (exp >= 0 && static_cast<size_t>(exp) < 2 * dense_.size()) {
+            vector<C>& dense = dense_.mutate();
+            if (static_cast<size_t>(exp) >= dense.size()) {
+                dense.resize(static_cast<size_t>(exp) + 1, C());
+            }
+            bool was_zero = dense[exp] == C();
+            coefficient_traits<C>::add_to(dense[exp], term.get_coefficient());
+            cnt_ += static_cast<int>(dense[exp] != C()) - static_cast<int>(!was_zero);
+            while (!dense.empty() && dense.back() == C()) {
+                dense.pop_back();
+            }
+            if (cnt_ == 0) {
+                is_dense_ = false;
+            }
+            update_representation();
+            return;
+        }
+        to_sparse();
+    }
+
     resize_if_needed();
-    terms_[cnt_] = term;
+    coeffs_[cnt_] = term.get_coefficient();
+    exps_[cnt_] = term.get_exponent();
     ++cnt_;
     sort_terms();
     combine_like_terms();
     remove_zero_terms();
+    update_representation();
 }
 
 // 获取指定索引的项
-const Term& Polynomial::get_term(int index) const {
+template <typename C, typename E>
+typename BasicPolynomial<C, E>::Term BasicPolynomial<C, E>::get_term(int index) const {
     if (index < 0 || index >= cnt_) {
         throw out_of_range("Term index out of range");
     }
-    return terms_[index];
+    if (is_dense_) {
+        for (E e = static_cast<E>(dense_.size()) - 1; e >= 0; --e) {
+            if (dense_[e] != C() && index-- == 0) {
+                return Term(dense_[e], e);
+            }
+        }
+    }
+    return Term(coeffs_[index], exps_[index]);
+}
+
+template <typename C, typename E>
+void BasicPolynomial<C, E>::clear() {
+    cnt_ = 0;
+    if (is_dense_) {
+        dense_.release();
+        is_dense_ = false;
+    }
+    if (shares_terms()) {
+        release_terms();
+    }
+}
+
+// 把 n 项复制到 (dst_coeffs, dst_exps), sign = -1 时系数取反
+template <typename C, typename E>
+static void copy_terms(const C* coeffs, const E* exps, size_t n, int sign, C* dst_coeffs, E* dst_exps) {
+    copy(exps, exps + n, dst_exps);
+    if (sign > 0) {
+        copy(coeffs, coeffs + n, dst_coeffs);
+    } else if constexpr (simd_terms<C, E>::value) {
+        poly_simd::negate(coeffs, dst_coeffs, n);
+    } else {
+        for (size_t k = 0; k < n; ++k) {
+            dst_coeffs[k] = coefficient_traits<C>::negate(coeffs[k]);
+        }
+    }
+}
+
+// 归并两个按指数降序的项序列, 写入 (oc, oe), 返回写入的项数
+// 只接收数组指针: 写入 int 指数时编译器无法排除与成员 cnt_ 重叠, 在成员上直接循环会反复重新读取
+template <typename C, typename E>
+static int merge_terms(const C* lc, const E* le, int n, const C* rc, const E* re, int m, int sign,
+                       C* oc, E* oe) {
+    int i = 0, j = 0, w = 0;
+    while (i < n && j < m) {
+        E exp_l = le[i];
+        E exp_r = re[j];
+        if (exp_l > exp_r) {
+            oc[w] = lc[i++];
+            oe[w++] = exp_l;
+        } else if (exp_l < exp_r) {
+            oc[w] = apply_sign(rc[j++], sign);
+            oe[w++] = exp_r;
+        } else {
+            C coeff = lc[i];
+            accumulate_signed(coeff, rc[j], sign);
+            if (coeff != C()) {
+                oc[w] = coeff;
+                oe[w++] = exp_l;
+            }
+            ++i;
+            ++j;
+        }
+    }
+    // 剩余部分整段复制
+    copy_terms(lc + i, le + i, n - i, 1, oc + w, oe + w);
+    w += n - i;
+    copy_terms(rc + j, re + j, m - j, sign, oc + w, oe + w);
+    return w + (m - j);
+}
+
+// 双指针归并: 两个操作数均按指数降序且无零系数, 结果一次写入预分配的数组
+template <typename C, typename E>
+BasicPolynomial<C, E> BasicPolynomial<C, E>::merge(const BasicPolynomial& lhs, const BasicPolynomial& rhs, int sign) {
+    BasicPolynomial result(lhs.cnt_ + rhs.cnt_ > 0 ? lhs.cnt_ + rhs.cnt_ : 1);
+    result.cnt_ = merge_terms(lhs.coeffs_, lhs.exps_, lhs.cnt_, rhs.coeffs_, rhs.exps_, rhs.cnt_, sign,
+                              result.coeffs_, result.exps_);
+    return result;
+}
+
+// 原地归并: 先预留 cnt_ + other.cnt_ 的空间, 从两个序列的尾部 (指数最小处) 向前归并,
+// 写指针始终不小于本对象的读指针, 因此不会覆盖尚未读取的项; 最后把结果段前移
+template <typename C, typename E>
+void BasicPolynomial<C, E>::merge_in_place(const BasicPolynomial& other, int sign) {
+    if (this == &other) {
+        if (sign < 0) {
+            cnt_ = 0;
+            return;
+        }
+        make_terms_unique();
+        if constexpr (simd_terms<C, E>::value) {
+            poly_simd::add(coeffs_, coeffs_, cnt_);
+        } else {
+            for (int k = 0; k < cnt_; ++k) {
+                coefficient_traits<C>::add_to(coeffs_[k], coeffs_[k]);
+            }
+        }
+        remove_zero_terms();
+        return;
+    }
+    if (other.cnt_ == 0) {
+        return;
+    }
+
+    reserve(static_cast<size_t>(cnt_) + other.cnt_);
+
+    int i = cnt_ - 1;
+    int j = other.cnt_ - 1;
+    int w = cnt_ + other.cnt_ - 1;
+    while (j >= 0 && i >= 0) {
+        E exp_r = other.exps_[j];
+        if (exps_[i] < exp_r) {
+            coeffs_[w] = std::move(coeffs_[i]);
+            exps_[w--] = exps_[i--];
+        } else if (exps_[i] == exp_r) {
+            C coeff = coeffs_[i];
+            accumulate_signed(coeff, other.coeffs_[j], sign);
+            if (coeff != C()) {
+                coeffs_[w] = std::move(coeff);
+                exps_[w--] = exp_r;
+            }
+            --i;
+            --j;
+        } else {
+            coeffs_[w] = apply_sign(other.coeffs_[j--], sign);
+            exps_[w--] = exp_r;
+        }
+    }
+    // 本对象已读完时, other 剩余的高次项整段写入
+    if (j >= 0) {
+        copy_terms(other.coeffs_, other.exps_, j + 1, sign, coeffs_ + (w - j), exps_ + (w - j));
+        w -= j + 1;
+    }
+
+    // coeffs_[0..i] 为未参与归并的高次项, coeffs_[w+1..] 为归并结果
+    int head = i + 1;
+    int tail_start = w + 1;
+    int tail_len = cnt_ + other.cnt_ - tail_start;
+    if (tail_start != head) {
+        for (int k = 0; k < tail_len; ++k) {
+            coeffs_[head + k] = std::move(coeffs_[tail_start + k]);
+            exps_[head + k] = exps_[tail_start + k];
+        }
+    }
+    cnt_ = head + tail_len;
+}
+
+// += / -= : 有一侧为稠密且结果仍然稠密时在系数数组上逐位累加, 否则转为稀疏归并
+template <typename C, typename E>
+void BasicPolynomial<C, E>::add_in_place(const BasicPolynomial& other, int sign) {
+    if (this == &other) {
+        if (sign < 0) {
+            clear();
+            return;
+        }
+        if (is_dense_) {
+            vector<C>& dense = dense_.mutate();
+            if constexpr (simd_terms<C, E>::value) {
+                poly_simd::add(dense.data(), dense.data(), dense.size());
+            } else {
+                for (size_t e = 0; e < dense.size(); ++e) {
+                    coefficient_traits<C>::add_to(dense[e], dense[e]);
+                }
+            }
+            normalize_dense();
+            update_representation();
+            return;
+        }
+        merge_in_place(other, sign);
+        update_representation();
+        return;
+    }
+    if (other.cnt_ == 0) {
+        return;
+    }
+
+    if ((is_dense_ || other.is_dense_) && fits_dense_with(other)) {
+        to_dense();
+        vector<C>& dense = dense_.mutate();
+        if (static_cast<size_t>(other.max_exponent()) >= dense.size()) {
+            dense.resize(static_cast<size_t>(other.max_exponent()) + 1, C());
+        }
+        if (other.is_dense_) {
+            if constexpr (simd_terms<C, E>::value) {
+                if (sign > 0) {
+                    poly_simd::add(other.dense_.data(), dense.data(), other.dense_.size());
+                } else {
+                    poly_simd::sub(other.dense_.data(), dense.data(), other.dense_.size());
+                }
+            } else {
+                for (size_t e = 0; e < other.dense_.size(); ++e) {
+                    accumulate_signed(dense[e], other.dense_[e], sign);
+                }
+            }
+        } else {
+            for (int i = 0; i < other.cnt_; ++i) {
+                accumulate_signed(dense[other.exps_[i]], other.coeffs_[i], sign);
+            }
+        }
+        normalize_dense();
+        update_representation();
+        return;
+    }
+
+    to_sparse();
+    if (other.is_dense_) {
+        merge_in_place(other.sparse_copy(), sign);
+    } else {
+        merge_in_place(other, sign);
+    }
+    update_representation();
+}
+
+// 多项式加法
+template <typename C, typename E>
+BasicPolynomial<C, E> BasicPolynomial<C, E>::operator+(const BasicPolynomial& other) const {
+    if (!is_dense_ && !other.is_dense_) {
+        BasicPolynomial result = merge(*this, other, 1);
+        result.update_representation();
+        return result;
+    }
+    BasicPolynomial result(*this);
+    result.add_in_place(other, 1);
+    return result;
+}
+
+// 多项式减法
+template <typename C, typename E>
+BasicPolynomial<C, E> BasicPolynomial<C, E>::operator-(const BasicPolynomial& other) const {
+    if (!is_dense_ && !other.is_dense_) {
+        BasicPolynomial result = merge(*this, other, -1);
+        result.update_representation();
+        return result;
+    }
+    BasicPolynomial result(*this);
+    result.add_in_place(other, -1);
+    return result;
+}
+
+// 在尾部追加一项
+template <typename C, typename E>
+void BasicPolynomial<C, E>::append_term(const C& coefficient, E exponent) {
+    resize_if_needed();
+    coeffs_[cnt_] = coefficient;
+    exps_[cnt_++] = exponent;
+}
+
+// 稠密累加器的最大长度 (系数个数), 超过则改用堆归并, 保证额外内存有界
+static const long long MAX_ACCUMULATOR_SPAN = 1LL << 22;
+
+// 多路归并中的一个有序序列, 指向尚未读取的第一项
+template <typename C, typename E>
+struct TermStream {
+    E exponent;       // 当前项的指数
+    const C* coeff;   // 当前项的系数
+    const E* exp;     // 当前项的指数位置
+    const E* end;     // 序列末尾
+    int sign;         // 该操作数的符号
+};
+
+// 最大堆 (按指数) 的堆顶变化后下沉; 归并时堆顶前进一项后只需这一次调整, 不必先弹出再压入
+template <typename C, typename E>
+static void sift_down(TermStream<C, E>* heap, size_t size) {
+    TermStream<C, E> item = heap[0];
+    size_t i = 0;
+    while (2 * i + 1 < size) {
+        size_t child = 2 * i + 1;
+        if (child + 1 < size && heap[child + 1].exponent > heap[child].exponent) {
+            ++child;
+        }
+        if (heap[child].exponent <= item.exponent) {
+            break;
+        }
+        heap[i] = heap[child];
+        i = child;
+    }
+    heap[i] = item;
+}
+
+// 归并堆中的 size 个序列 (已建成最大堆), 同指数项合并, 写入 (oc, oe), 返回写入的项数
+// 与 merge_terms 相同, 只接收数组指针
+template <typename C, typename E>
+static int merge_streams(TermStream<C, E>* heap, size_t size, C* oc, E* oe) {
+    int w = 0;
+    while (size > 0) {
+        E exponent = heap[0].exponent;
+        C coeff = C();
+
+        // 累加所有指数相同的项: 堆顶序列前进一项 (读完则用堆尾替换) 后下沉
+        do {
+            TermStream<C, E>& top = heap[0];
+            accumulate_signed(coeff, *top.coeff, top.sign);
+            ++top.coeff;
+            if (++top.exp != top.end) {
+                top.exponent = *top.exp;
+            } else {
+                top = heap[--size];
+            }
+            sift_down(heap, size);
+        } while (size > 0 && heap[0].exponent == exponent);
+
+        if (coeff != C()) {
+            oc[w] = coeff;
+            oe[w++] = exponent;
+        }
+    }
+    return w;
+}
+
+// 代数和: 先统计总项数和指数范围
+//  - 指数跨度不超过两倍总项数: 数组按指数累加, 稠密操作数整段相加
+//  - 否则: 最大堆同时归并各操作数的有序序列, 同指数项在弹出时合并, O(N log count)
+// 两种方式都只生成一个结果, 不产生中间多项式
+template <typename C, typename E>
+BasicPolynomial<C, E> BasicPolynomial<C, E>::sum(const BasicPolynomial* const* operands, const int* signs, size_t count) {
+    size_t total = 0;
+    E low = 0;
+    E high = 0;
+    for (size_t k = 0; k < count; ++k) {
+        const BasicPolynomial& poly = *operands[k];
+        if (poly.cnt_ == 0) {
+            continue;
+        }
+        E poly_low = poly.min_exponent();
+        E poly_high = poly.max_exponent();
+        low = total == 0 ? poly_low : min(low, poly_low);
+        high = total == 0 ? poly_high : max(high, poly_high);
+        total += poly.cnt_;
+    }
+    if (total == 0) {
+        return BasicPolynomial();
+    }
+
+    long long span = static_cast<long long>(high) - low + 1;
+    if (span <= MAX_ACCUMULATOR_SPAN && span <= 2 * static_cast<long long>(total)) {
+        // 最低指数非负且不大时直接以 0 为起点, 累加结果即为稠密数组
+        E base = low >= 0 && low <= span ? 0 : low;
+        vector<C> acc(static_cast<size_t>(high - base) + 1, C());
+        for (size_t k = 0; k < count; ++k) {
+            const BasicPolynomial& poly = *operands[k];
+            int sign = signs[k];
+            if (poly.cnt_ == 0) {
+                continue;
+            }
+            if (poly.is_dense_) {
+                // 低于 base 的系数都为零, 从 base 开始整段累加
+                size_t start = base > 0 ? static_cast<size_t>(base) : 0;
+                size_t n = poly.dense_.size() - start;
+                const C* src = poly.dense_.data() + start;
+                C* dst = acc.data() + (static_cast<E>(start) - base);
+                if constexpr (simd_terms<C, E>::value) {
+                    if (sign > 0) {
+                        poly_simd::add(src, dst, n);
+                    } else {
+                        poly_simd::sub(src, dst, n);
+                    }
+                } else {
+                    for (size_t e = 0; e < n; ++e) {
+                        accumulate_signed(dst[e], src[e], sign);
+                    }
+                }
+            } else {
+                for (int i = 0; i < poly.cnt_; ++i) {
+                    accumulate_signed(acc[poly.exps_[i] - base], poly.coeffs_[i], sign);
+                }
+            }
+        }
+
+        if (base == 0) {
+            return from_dense(std::move(acc));
+        }
+        BasicPolynomial result(total);
+        for (size_t k = acc.size(); k-- > 0;) {
+            if (acc[k] != C()) {
+                result.append_term(acc[k], base + static_cast<E>(k));
+            }
+        }
+        result.update_representation();
+        return result;
+    }
+
+    auto less_exponent = [](const TermStream<C, E>& x, const TermStream<C, E>& y) {
+        return x.exponent < y.exponent;
+    };
+
+    // 稠密操作数先转为稀疏副本
+    vector<BasicPolynomial> sparse_copies;
+    sparse_copies.reserve(count_if(operands, operands + count, [](const BasicPolynomial* poly) {
+        return poly->is_dense_;
+    }));
+
+    vector<TermStream<C, E>> heap;
+    heap.reserve(count);
+    for (size_t k = 0; k < count; ++k) {
+        const BasicPolynomial* poly = operands[k];
+        if (poly->cnt_ == 0) {
+            continue;
+        }
+        if (poly->is_dense_) {
+            sparse_copies.push_back(poly->sparse_copy());
+            poly = &sparse_copies.back();
+        }
+        heap.push_back({poly->exps_[0], poly->coeffs_, poly->exps_, poly->exps_ + poly->cnt_, signs[k]});
+    }
+    make_heap(heap.begin(), heap.end(), less_exponent);
+
+    BasicPolynomial result(total);
+    result.cnt_ = merge_streams(heap.data(), heap.size(), result.coeffs_, result.exps_);
+    result.update_representation();
+    return result;
+}
+
+// 两个稀疏多项式相乘, 按乘积的指数跨度选择算法
+//  - 跨度不超过部分积个数且不超过累加器上限: 数组累加, O(n*m + span)
+//  - 否则: 堆归并, O(n*m*log(min(n, m))), 额外内存 O(min(n, m))
+template <typename C, typename E>
+BasicPolynomial<C, E> BasicPolynomial<C, E>::multiply_sparse(const BasicPolynomial& lhs, const BasicPolynomial& rhs) {
+    long long span = static_cast<long long>(lhs.exps_[0]) + rhs.exps_[0]
+                   - lhs.exps_[lhs.cnt_ - 1] - rhs.exps_[rhs.cnt_ - 1] + 1;
+    long long products = static_cast<long long>(lhs.cnt_) * rhs.cnt_;
+
+    if (span <= products && span <= MAX_ACCUMULATOR_SPAN) {
+        return multiply_accumulate(lhs, rhs);
+    }
+    return multiply_heap(lhs, rhs);
+}
+
+// 稀疏多项式乘单项式: 系数整段乘以常数, 指数整段平移 (整数回绕可能产生零系数, 需要压缩)
+template <typename C, typename E>
+BasicPolynomial<C, E> BasicPolynomial<C, E>::multiply_monomial(const BasicPolynomial& poly, const C& coeff, E exp) {
+    BasicPolynomial result(poly.cnt_);
+    if constexpr (simd_terms<C, E>::value) {
+        poly_simd::scale(poly.coeffs_, coeff, result.coeffs_, poly.cnt_);
+    } else {
+        for (int i = 0; i < poly.cnt_; ++i) {
+            result.coeffs_[i] = coefficient_traits<C>::mul(poly.coeffs_[i], coeff);
+        }
+    }
+    for (int i = 0; i < poly.cnt_; ++i) {
+        result.exps_[i] = poly.exps_[i] + exp;
+    }
+    result.cnt_ = poly.cnt_;
+    result.remove_zero_terms();
+    return result;
+}
+
+// 稠密 x 稠密: 系数数组卷积
+template <typename C, typename E>
+BasicPolynomial<C, E> BasicPolynomial<C, E>::multiply_dense(const BasicPolynomial& lhs, const BasicPolynomial& rhs) {
+    return from_dense(poly_kernels::convolve(lhs.dense_.get(), rhs.dense_.get()));
+}
+
+// 稠密 x 稀疏: 稀疏项较少时把稠密数组乘以系数后平移累加, 较多时展开成数组后卷积
+template <typename C, typename E>
+BasicPolynomial<C, E> BasicPolynomial<C, E>::multiply_dense_sparse(const BasicPolynomial& dense, const BasicPolynomial& sparse) {
+    const vector<C>& a = dense.dense_.get();
+
+    if (static_cast<size_t>(sparse.cnt_) > poly_kernels::KARATSUBA_THRESHOLD) {
+        vector<C> b(static_cast<size_t>(sparse.exps_[0]) + 1, C());
+        for (int i = 0; i < sparse.cnt_; ++i) {
+            b[sparse.exps_[i]] = sparse.coeffs_[i];
+        }
+        return from_dense(poly_kernels::convolve(a, b));
+    }
+
+    vector<C> coeffs(a.size() + sparse.exps_[0], C());
+    for (int i = 0; i < sparse.cnt_; ++i) {
+        const C& coeff = sparse.coeffs_[i];
+        C* out = coeffs.data() + sparse.exps_[i];
+        if constexpr (simd_terms<C, E>::value) {
+            poly_simd::scale_add(a.data(), coeff, out, a.size());
+        } else {
+            for (size_t j = 0; j < a.size(); ++j) {
+                coefficient_traits<C>::add_to(out[j], coefficient_traits<C>::mul(coeff, a[j]));
+            }
+        }
+    }
+    return from_dense(std::move(coeffs));
+}
+
+// 多项式乘法: 按两侧的存储方式分派
+template <typename C, typename E>
+BasicPolynomial<C, E> BasicPolynomial<C, E>::operator*(const BasicPolynomial& other) const {
+    if (cnt_ == 0 || other.cnt_ == 0) {
+        return BasicPolynomial();
+    }
+
+    BasicPolynomial result;
+    if (is_dense_ && other.is_dense_) {
+        result = multiply_dense(*this, other);
+    } else if (!is_dense_ && !other.is_dense_ && (cnt_ == 1 || other.cnt_ == 1)) {
+        const BasicPolynomial& monomial = cnt_ == 1 ? *this : other;
+        const BasicPolynomial& poly = cnt_ == 1 ? other : *this;
+        result = multiply_monomial(poly, monomial.coeffs_[0], monomial.exps_[0]);
+    } else if (is_dense_ || other.is_dense_) {
+        const BasicPolynomial& dense = is_dense_ ? *this : other;
+        const BasicPolynomial& sparse = is_dense_ ? other : *this;
+        // 稀疏一侧指数非负且次数不超过稠密长度时结果仍然稠密
+        if (sparse.min_exponent() >= 0 &&
+            static_cast<size_t>(sparse.max_exponent()) <= dense.dense_.size()) {
+            result = multiply_dense_sparse(dense, sparse);
+        } else {
+            result = multiply_sparse(dense.sparse_copy(), sparse);
+        }
+    } else {
+        result = multiply_sparse(*this, other);
+    }
+    result.update_representation();
+    return result;
+}
+
+// 稠密累加乘法
+template <typename C, typename E>
+BasicPolynomial<C, E> BasicPolynomial<C, E>::multiply_accumulate(const BasicPolynomial& lhs, const BasicPolynomial& rhs) {
+    E max_exp = lhs.exps_[0] + rhs.exps_[0];
+    E min_exp = lhs.exps_[lhs.cnt_ - 1] + rhs.exps_[rhs.cnt_ - 1];
+    size_t span = static_cast<size_t>(max_exp - min_exp) + 1;
+
+    // acc[k] 为 x^(max_exp - k) 的系数, 下标递增即指数递减
+    vector<C> acc(span, C());
+    for (int i = 0; i < lhs.cnt_; ++i) {
+        const C& coeff_l = lhs.coeffs_[i];
+        E offset = max_exp - lhs.exps_[i];
+        for (int j = 0; j < rhs.cnt_; ++j) {
+            coefficient_traits<C>::add_to(acc[offset - rhs.exps_[j]], coefficient_traits<C>::mul(coeff_l, rhs.coeffs_[j]));
+        }
+    }
+
+    size_t nonzero = 0;
+    if constexpr (simd_terms<C, E>::value) {
+        nonzero = poly_simd::count_nonzero(acc.data(), span);
+    } else {
+        for (size_t k = 0; k < span; ++k) {
+            if (acc[k] != C()) {
+                ++nonzero;
+            }
+        }
+    }
+
+    BasicPolynomial result(nonzero > 0 ? nonzero : 1);
+    for (size_t k = 0; k < span; ++k) {
+        if (acc[k] != C()) {
+            result.coeffs_[result.cnt_] = acc[k];
+            result.exps_[result.cnt_++] = max_exp - static_cast<E>(k);
+        }
+    }
+    return result;
+}
+
+// 堆中的一条部分积流: small[i] * big[j]
+template <typename E>
+struct ProductStream {
+    E exponent;    // 当前乘积项的指数
+    int i;         // 较短多项式中的下标
+    int j;         // 较长多项式中的下标
+};
+
+// 堆归并乘法 (Johnson / Monagan-Pearce)
+// 较短多项式的每一项对应一条按指数降序的部分积流, 最大堆每次弹出指数最大的项,
+// 同指数项在弹出时直接合并。第 i+1 条流在第 i 条流推进到第二项时才入堆,
+// 因此堆的大小不超过 min(n, m)。
+template <typename C, typename E>
+BasicPolynomial<C, E> BasicPolynomial<C, E>::multiply_heap(const BasicPolynomial& lhs, const BasicPolynomial& rhs) {
+    const BasicPolynomial& small = lhs.cnt_ <= rhs.cnt_ ? lhs : rhs;
+    const BasicPolynomial& big = lhs.cnt_ <= rhs.cnt_ ? rhs : lhs;
+
+    auto less_exponent = [](const ProductStream<E>& x, const ProductStream<E>& y) {
+        return x.exponent < y.exponent;
+    };
+
+    vector<ProductStream<E>> heap;
+    heap.reserve(small.cnt_);
+    heap.push_back({small.exps_[0] + big.exps_[0], 0, 0});
+
+    BasicPolynomial result(static_cast<size_t>(small.cnt_) + big.cnt_);
+
+    while (!heap.empty()) {
+        E exponent = heap.front().exponent;
+        C coeff = C();
+
+        // 弹出所有指数相同的部分积并累加
+        while (!heap.empty() && heap.front().exponent == exponent) {
+            pop_heap(heap.begin(), heap.end(), less_exponent);
+            ProductStream<E> stream = heap.back();
+            heap.pop_back();
+
+            coefficient_traits<C>::add_to(coeff, coefficient_traits<C>::mul(small.coeffs_[stream.i], big.coeffs_[stream.j]));
+
+            // 启动下一条流
+            if (stream.j == 0 && stream.i + 1 < small.cnt_) {
+                heap.push_back({small.exps_[stream.i + 1] + big.exps_[0], stream.i + 1, 0});
+                push_heap(heap.begin(), heap.end(), less_exponent);
+            }
+            // 当前流前进一项
+            if (stream.j + 1 < big.cnt_) {
+                ++stream.j;
+                stream.exponent = small.exps_[stream.i] + big.exps_[stream.j];
+                heap.push_back(stream);
+                push_heap(heap.begin(), heap.end(), less_exponent);
+            }
+        }
+
+        if (coeff != C()) {
+            result.append_term(coeff, exponent);
+        }
+    }
+
+    return result;
+}
+
+// 稀疏平方: c_i c_j 与 c_j c_i 相同, 只计算 i <= j 的乘积, i < j 的交叉项加倍
+//  - 跨度较小: 数组累加, 约 n^2 / 2 次乘法
+//  - 否则: 堆归并, 第 i 条流为 c_i c_j (j >= i), 首项 x^(2 e_i) 小于第 i-1 条流的第二项,
+//    因此第 i-1 条流弹出首项时再启动第 i 条流, 堆的大小不超过 n
+template <typename C, typename E>
+BasicPolynomial<C, E> BasicPolynomial<C, E>::square_sparse(const BasicPolynomial& poly) {
+    const int n = poly.cnt_;
+    const C* coeffs = poly.coeffs_;
+    const E* exps = poly.exps_;
+    E max_exp = exps[0] + exps[0];
+    long long span = 2LL * (static_cast<long long>(exps[0]) - exps[n - 1]) + 1;
+    long long products = static_cast<long long>(n) * (n + 1) / 2;
+
+    if (span <= products && span <= MAX_ACCUMULATOR_SPAN) {
+        // acc[k] 为 x^(max_exp - k) 的系数
+        vector<C> acc(static_cast<size_t>(span), C());
+        for (int i = 0; i < n; ++i) {
+            const C& coeff_i = coeffs[i];
+            E offset = max_exp - exps[i];
+            for (int j = i + 1; j < n; ++j) {
+                coefficient_traits<C>::add_to(acc[offset - exps[j]], coefficient_traits<C>::mul(coeff_i, coeffs[j]));
+            }
+        }
+        for (size_t k = 0; k < acc.size(); ++k) {
+            coefficient_traits<C>::add_to(acc[k], acc[k]);
+        }
+        for (int i = 0; i < n; ++i) {
+            coefficient_traits<C>::add_to(acc[max_exp - exps[i] - exps[i]], coefficient_traits<C>::mul(coeffs[i], coeffs[i]));
+        }
+
+        BasicPolynomial result(static_cast<size_t>(n) * 2);
+        for (size_t k = 0; k < acc.size(); ++k) {
+            if (acc[k] != C()) {
+                result.append_term(acc[k], max_exp - static_cast<E>(k));
+            }
+        }
+        return result;
+    }
+
+    auto less_exponent = [](const ProductStream<E>& x, const ProductStream<E>& y) {
+        return x.exponent < y.exponent;
+    };
+
+    vector<ProductStream<E>> heap;
+    heap.reserve(n);
+    heap.push_back({max_exp, 0, 0});
+
+    BasicPolynomial result(static_cast<size_t>(n) * 2);
+
+    while (!heap.empty()) {
+        E exponent = heap.front().exponent;
+        C coeff = C();
+
+        while (!heap.empty() && heap.front().exponent == exponent) {
+            pop_heap(heap.begin(), heap.end(), less_exponent);
+            ProductStream<E> stream = heap.back();
+            heap.pop_back();
+
+            if (stream.i == stream.j) {
+                coefficient_traits<C>::add_to(coeff, coefficient_traits<C>::mul(coeffs[stream.i], coeffs[stream.i]));
+                // 启动下一条流
+                if (stream.i + 1 < n) {
+                    heap.push_back({exps[stream.i + 1] + exps[stream.i + 1], stream.i + 1, stream.i + 1});
+                    push_heap(heap.begin(), heap.end(), less_exponent);
+                }
+            } else {
+                C product = coefficient_traits<C>::mul(coeffs[stream.i], coeffs[stream.j]);
+                coefficient_traits<C>::add_to(coeff, product);
+                coefficient_traits<C>::add_to(coeff, product);
+            }
+            if (stream.j + 1 < n) {
+                ++stream.j;
+                stream.exponent = exps[stream.i] + exps[stream.j];
+                heap.push_back(stream);
+                push_heap(heap.begin(), heap.end(), less_exponent);
+            }
+        }
+
+        if (coeff != C()) {
+            result.append_term(coeff, exponent);
+        }
+    }
+
+    return result;
+}
+
+// 平方: 稠密时系数数组自卷积 (卷积内核识别同一数组后按平方计算), 稀疏时只算一半的乘积
+template <typename C, typename E>
+BasicPolynomial<C, E> BasicPolynomial<C, E>::square() const {
+    if (cnt_ == 0) {
+        return BasicPolynomial();
+    }
+
+    BasicPolynomial result;
+    if (is_dense_) {
+        const vector<C>& a = dense_.get();
+        result = from_dense(poly_kernels::convolve(a, a));
+    } else if (cnt_ == 1) {
+        result = multiply_monomial(*this, coeffs_[0], exps_[0]);
+    } else {
+        result = square_sparse(*this);
+    }
+    result.update_representation();
+    return result;
+}
+
+template <typename C, typename E>
+BasicPolynomial<C, E>& BasicPolynomial<C, E>::operator+=(const BasicPolynomial& other) {
+    add_in_place(other, 1);
+    return *this;
+}
+
+
+template <typename C, typename E>
+BasicPolynomial<C, E>& BasicPolynomial<C, E>::operator-=(const BasicPolynomial& other) {
+    add_in_place(other, -1);
+    return *this;
+}
+
+
+template <typename C, typename E>
+BasicPolynomial<C, E>& BasicPolynomial<C, E>::operator*=(const BasicPolynomial& other) {
+    *this = *this * other;
+    return *this;
+}
+
+// 求值时使用的运算类型: 定宽整数系数换成同宽度的无符号数, 回绕运算结果与有符号相同,
+// 没有溢出的未定义行为, 编译器也更容易向量化
+template <typename C>
+struct evaluation_word {
+    using type = C;
+};
+
+template <>
+struct evaluation_word<int> {
+    using type = uint32_t;
+};
+
+template <>
+struct evaluation_word<int64_t> {
+    using type = uint64_t;
+};
+
+#if POLYNOMIAL_HAS_INT128
+template <>
+struct evaluation_word<__int128> {
+    using type = unsigned __int128;
+};
+#endif
+
+// 批量求值每次同时计算的点数; 机器字系数的各点在内层循环中互相独立, 可被编译为 SIMD 乘加
+template <typename C>
+static constexpr size_t evaluation_lanes() {
+    return coefficient_traits<C>::machine_word ? 8 : 1;
+}
+
+// 子乘积树的适用条件: 点数达到阈值、非零项数不少于阈值的一半, 且次数不超过点数的
+// MULTIPOINT_MAX_DEGREE_RATIO 倍 (项数少或次数很高的稀疏多项式逐点按指数差 Horner 更快)
+// 阈值为实测交叉点: 机器字系数逐点求值可以 8 路并行, 约 8192 点后子乘积树才更快;
+// 其他系数逐点求值为标量运算, 约 512 点即可; 任意精度系数在树中系数膨胀, 始终逐点求值
+static const size_t MULTIPOINT_MIN_POINTS_MACHINE_WORD = 8192;
+static const size_t MULTIPOINT_MIN_POINTS = 512;
+static const size_t MULTIPOINT_MAX_DEGREE_RATIO = 4;
+
+template <typename C>
+static bool use_multipoint(int term_count, long long degree, size_t count) {
+    if (is_same<C, BigInt>::value) {
+        return false;
+    }
+    size_t min_points = coefficient_traits<C>::machine_word ? MULTIPOINT_MIN_POINTS_MACHINE_WORD
+                                                            : MULTIPOINT_MIN_POINTS;
+    return count >= min_points && 2 * static_cast<size_t>(term_count) >= min_points &&
+           static_cast<unsigned long long>(degree) + 1 <= MULTIPOINT_MAX_DEGREE_RATIO * count;
+}
+
+// 同时在 LANES 个点上求值 (count <= LANES, 多余的点按 0 计算后丢弃)
+//  - 稠密: Horner 法则, 每个系数一次乘加
+//  - 稀疏: 按指数降序在相邻项的指数差上做 Horner, x^gap 用平方求幂计算,
+//          与上一个指数差相同时直接复用, 总代价 O(n log(max gap)) 而非 O(指数之和)
+// 非正指数的项与原实现一致, 按常数项计入
+template <typename C, typename E>
+template <size_t LANES>
+void BasicPolynomial<C, E>::evaluate_lanes(const C* xs, size_t count, C* out) const {
+    using U = typename evaluation_word<C>::type;
+
+    U x[LANES], r[LANES];
+    for (size_t l = 0; l < LANES; ++l) {
+        x[l] = l < count ? static_cast<U>(xs[l]) : U();
+        r[l] = U();
+    }
+
+    if (is_dense_) {
+        for (E e = static_cast<E>(dense_.size()) - 1; e >= 0; --e) {
+            U c = static_cast<U>(dense_[e]);
+            for (size_t l = 0; l < LANES; ++l) {
+                r[l] = r[l] * x[l] + c;
+            }
+        }
+    } else {
+        U power[LANES], base[LANES];
+        E last_gap = 0;
+        E prev = 0;
+        U constant = U();
+        int i = 0;
+        for (; i < cnt_ && exps_[i] > 0; ++i) {
+            E exp = exps_[i];
+            if (i > 0) {
+                E gap = prev - exp;
+                if (gap == 1) {
+                    for (size_t l = 0; l < LANES; ++l) {
+                        r[l] = r[l] * x[l];
+                    }
+                } else {
+                    if (gap != last_gap) {
+                        for (size_t l = 0; l < LANES; ++l) {
+                            power[l] = U(1);
+                            base[l] = x[l];
+                        }
+                        for (E g = gap; g > 0; g >>= 1) {
+                            if (g & 1) {
+                                for (size_t l = 0; l < LANES; ++l) {
+                                    power[l] = power[l] * base[l];
+                                }
+                            }
+                            if (g > 1) {
+                                for (size_t l = 0; l < LANES; ++l) {
+                                    base[l] = base[l] * base[l];
+                                }
+                            }
+                        }
+                        last_gap = gap;
+                    }
+                    for (size_t l = 0; l < LANES; ++l) {
+                        r[l] = r[l] * power[l];
+                    }
+                }
+            }
+            U c = static_cast<U>(coeffs_[i]);
+            for (size_t l = 0; l < LANES; ++l) {
+                r[l] = r[l] + c;
+            }
+            prev = exp;
+        }
+
+        // 乘上最低正指数 x^prev
+        if (i > 0) {
+            for (size_t l = 0; l < LANES; ++l) {
+                power[l] = U(1);
+                base[l] = x[l];
+            }
+            for (E g = prev; g > 0; g >>= 1) {
+                if (g & 1) {
+                    for (size_t l = 0; l < LANES; ++l) {
+                        power[l] = power[l] * base[l];
+                    }
+                }
+                if (g > 1) {
+                    for (size_t l = 0; l < LANES; ++l) {
+                        base[l] = base[l] * base[l];
+                    }
+                }
+            }
+            for (size_t l = 0; l < LANES; ++l) {
+                r[l] = r[l] * power[l];
+            }
+        }
+
+        for (; i < cnt_; ++i) {
+            constant = constant + static_cast<U>(coeffs_[i]);
+        }
+        for (size_t l = 0; l < LANES; ++l) {
+            r[l] = r[l] + constant;
+        }
+    }
+
+    for (size_t l = 0; l < count; ++l) {
+        out[l] = static_cast<C>(r[l]);
+    }
+}
+
+// 计算多项式在x处的值
+template <typename C, typename E>
+C BasicPolynomial<C, E>::evaluate(const C& x) const {
+    C result;
+    evaluate_lanes<1>(&x, 1, &result);
+    return result;
+}
+
+// 批量计算多项式在 xs[0..count) 处的值
+template <typename C, typename E>
+void BasicPolynomial<C, E>::evaluate_batch(const C* xs, size_t count, C* results) const {
+    if (use_multipoint<C>(cnt_, is_zero() ? 0 : degree(), count) && min_exponent() >= 0) {
+        evaluate_multipoint(xs, count, results);
+        return;
+    }
+
+    const size_t lanes = evaluation_lanes<C>();
+    for (size_t start = 0; start < count; start += lanes) {
+        size_t n = min(lanes, count - start);
+        evaluate_lanes<evaluation_lanes<C>()>(xs + start, n, results + start);
+    }
+}
+
+// 子乘积树多点求值
+template <typename C, typename E>
+void BasicPolynomial<C, E>::evaluate_multipoint(const C* xs, size_t count, C* results) const {
+    if (cnt_ == 0 || count == 0 || min_exponent() < 0) {
+        const size_t lanes = evaluation_lanes<C>();
+        for (size_t start = 0; start < count; start += lanes) {
+            evaluate_lanes<evaluation_lanes<C>()>(xs + start, min(lanes, count - start), results + start);
+        }
+        return;
+    }
+
+    vector<C> coeffs;
+    if (is_dense_) {
+        coeffs = dense_.get();
+    } else {
+        coeffs.assign(static_cast<size_t>(max_exponent()) + 1, C());
+        for (int i = 0; i < cnt_; ++i) {
+            coeffs[exps_[i]] = coeffs_[i];
+        }
+    }
+    vector<C> values = poly_multipoint::evaluate_multipoint(coeffs, vector<C>(xs, xs + count));
+    copy(values.begin(), values.end(), results);
+}
+
+// 计算多项式的导数
+template <typename C, typename E>
+BasicPolynomial<C, E> BasicPolynomial<C, E>::derivative() const {
+    if (is_dense_) {
+        vector<C> coeffs(dense_.size() - 1);
+        if constexpr (simd_terms<C, E>::value) {
+            poly_simd::derivative_dense(dense_.data(), coeffs.data(), coeffs.size());
+        } else {
+            for (size_t e = 1; e < dense_.size(); ++e) {
+                coeffs[e - 1] = coefficient_traits<C>::mul(dense_[e], coefficient_traits<C>::from_int64(static_cast<int64_t>(e)));
+            }
+        }
+        return from_dense(std::move(coeffs));
+    }
+
+    // 稀疏: 指数降序, 正指数的项构成前缀; 求导不改变相对顺序, 逐项计算后压缩掉零系数
+    int positive = 0;
+    while (positive < cnt_ && exps_[positive] > 0) {
+        ++positive;
+    }
+    BasicPolynomial result(positive > 0 ? positive : 1);
+    if constexpr (simd_terms<C, E>::value) {
+        poly_simd::derivative(coeffs_, exps_, result.coeffs_, result.exps_, positive);
+    } else {
+        for (int i = 0; i < positive; ++i) {
+            result.coeffs_[i] = coefficient_traits<C>::mul(coeffs_[i], coefficient_traits<C>::from_int64(static_cast<int64_t>(exps_[i])));
+            result.exps_[i] = exps_[i] - 1;
+        }
+    }
+    result.cnt_ = positive;
+    result.remove_zero_terms();
+
+    return result;
+}
+
+// 转换为标准输出格式字符串
+template <typename C, typename E>
+string BasicPolynomial<C, E>::to_standard_string() const {
+    string result;
+    TextWriter out(result);
+    write_standard_string(out);
+    return result;
+}
+
+// 转换为LaTeX格式字符串
+template <typename C, typename E>
+string BasicPolynomial<C, E>::to_latex_string() const {
+    string result;
+    TextWriter out(result);
+    write_latex_string(out);
+    return result;
+}
+
+// 标准格式: 项数, 之后按指数降序依次为系数、指数, 以逗号分隔
+template <typename C, typename E>
+void BasicPolynomial<C, E>::write_standard_string(TextWriter& out) const {
+    if (cnt_ == 0) {
+        out.append('0');
+        return;
+    }
+
+    out.append_number(cnt_);
+    for_each_term([&out](const C& coeff, E exp) {
+        out.append(',');
+        out.append_number(coeff);
+        out.append(',');
+        out.append_number(exp);
+    });
+}
+
+// LaTeX格式
+template <typename C, typename E>
+void BasicPolynomial<C, E>::write_latex_string(TextWriter& out) const {
+    if (cnt_ == 0) {
+        out.append('0');
+        return;
+    }
+
+    bool first = true;
+
+    for_each_term([&out, &first](C coeff, E exp) {
+        if (!first) {
+            if (!coefficient_traits<C>::is_negative(coeff)) {
+                out.append(" + ");
+            } else {
+                out.append(" - ");
+                coeff = coefficient_traits<C>::negate(coeff);
+            }
+        } else {
+            if (coefficient_traits<C>::is_negative(coeff)) {
+                out.append('-');
+                coeff = coefficient_traits<C>::negate(coeff);
+            }
+            first = false;
+        }
+        if (coeff != C(1) || exp == 0) {
+            out.append_number(coeff);
+        }
+        if (exp > 0) {
+            out.append('x');
+            if (exp > 1) {
+                out.append("^{");
+                out.append_number(exp);
+                out.append('}');
+            }
+        }
+    });
+}
+
+static bool is_space(char c) {
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v';
+}
+
+// 解析从 pos 开始的一个数 (前后可以有空白), 之后必须是 ',' 或输入结尾
+// 成功时 pos 移到 ',' 或结尾处; 失败时 pos 为出错的位置: 数字无法解析 (或溢出) 时为数字的开头, 数字后多出字符时为多出的字符
+// 不超过 64 位的内置整数类型直接在输入上调用 from_chars, 不需要先找出数字的结尾
+template <typename T>
+static bool parse_field(const char*& pos, const char* end, T& value) {
+    while (pos != end && is_space(*pos)) {
+        ++pos;
+    }
+    if constexpr (is_integral<T>::value && sizeof(T) <= sizeof(int64_t)) {
+        const char* first = pos;
+        if (first != end && *first == '+' && first + 1 != end && first[1] != '-') {
+            ++first; // from_chars 不接受正号
+        }
+        from_chars_result result = from_chars(first, end, value);
+        if (result.ec != errc()) {
+            return false;
+        }
+        pos = result.ptr;
+    } else {
+        const char* last = pos;
+        while (last != end && *last != ',' && !is_space(*last)) {
+            ++last;
+        }
+        if (!coefficient_traits<T>::parse(string_view(pos, static_cast<size_t>(last - pos)), value)) {
+            return false;
+        }
+        pos = last;
+    }
+    while (pos != end && is_space(*pos)) {
+        ++pos;
+    }
+    return pos == end || *pos == ',';
+}
+
+// 从 "c1,e1,c2,e2,..." 格式载入多项式
+// 先按逗号个数一次分配好数组, 扫描一遍直接解析进数组; 指数没有严格递减时排序一次, 再合并同类项、去掉零项
+template <typename C, typename E>
+bool BasicPolynomial<C, E>::load_from_string(string_view input, size_t* error_offset) {
+    clear();
+
+    const char* begin = input.data();
+    const char* end = begin + input.size();
+    const char* pos = begin;
+    while (pos != end && is_space(*pos)) {
+        ++pos;
+    }
+    if (pos == end) {
+        return true;
+    }
+
+    size_t fields = static_cast<size_t>(count(pos, end, ',')) + 1;
+    reserve((fields + 1) / 2);
+
+    bool descending = true;
+    for (;;) {
+        if (!parse_field(pos, end, coeffs_[cnt_])) {
+            break;
+        }
+        if (pos == end) {
+            break; // 缺少最后一项的指数
+        }
+        ++pos;
+        if (!parse_field(pos, end, exps_[cnt_])) {
+            break;
+        }
+        if (cnt_ > 0 && exps_[cnt_ - 1] <= exps_[cnt_]) {
+            descending = false;
+        }
+        ++cnt_;
+        if (pos == end) {
+            if (!descending) {
+                sort_terms();
+                combine_like_terms();
+            }
+            remove_zero_terms();
+            update_representation();
+            return true;
+        }
+        ++pos;
+    }
+
+    if (error_offset) {
+        *error_offset = static_cast<size_t>(pos - begin);
+    }
+    clear();
+    return false;
+}
+
+// 由 64 位整数数组载入多项式, 逐项转换后直接写入数组; canonical 时不排序、不合并, 只在复制时检查
+template <typename C, typename E>
+bool BasicPolynomial<C, E>::load_terms(const int64_t* coefficients, const int64_t* exponents, size_t count, size_t stride,
+                                       bool canonical, size_t* error_index) {
+    clear();
+    reserve(count);
+
+    bool descending = true;
+    for (size_t i = 0; i < count; ++i) {
+        int64_t coeff = coefficients[i * stride];
+        int64_t exp = exponents[i * stride];
+        bool fits = exp >= numeric_limits<E>::min() && exp <= numeric_limits<E>::max();
+        if constexpr (is_integral<C>::value && sizeof(C) < sizeof(int64_t)) {
+            fits = fits && coeff >= numeric_limits<C>::min() && coeff <= numeric_limits<C>::max();
+        }
+        if (!fits) {
+            if (error_index) {
+                *error_index = i;
+            }
+            clear();
+            return false;
+        }
+        coeffs_[cnt_] = coefficient_traits<C>::from_int64(coeff);
+        exps_[cnt_] = static_cast<E>(exp);
+        if (cnt_ > 0 && exps_[cnt_ - 1] <= exps_[cnt_]) {
+            if (canonical) {
+                if (error_index) {
+                    *error_index = i;
+                }
+                clear();
+                return false;
+            }
+            descending = false;
+        }
+        ++cnt_;
+    }
+
+    if (!descending) {
+        sort_terms();
+        combine_like_terms();
+    }
+    remove_zero_terms();
+    update_representation();
+    return true;
+}
+
+// 从字符串重建多项式, 格式错误时为零多项式
+template <typename C, typename E>
+void BasicPolynomial<C, E>::parse_from_string(const string& input) {
+    load_from_string(input);
+}
+
+// ============================================================================
+// PolynomialWorkspace类实现
+// ============================================================================
+
+template <typename C>
+BasicPolynomialWorkspace<C>::BasicPolynomialWorkspace() : snapshot_(make_shared<Snapshot>()), next_version_(0) {
+}
+
+// 默认工作区在第一次使用时构造
+template <typename C>
+BasicPolynomialWorkspace<C>& BasicPolynomialManager<C>::default_workspace() {
+    static BasicPolynomialWorkspace<C> workspace;
+    return workspace;
+}
+
+// 持有写锁时判断对象是否只被当前快照引用: 读者只在持有读锁时增加引用, 此时引用计数只会减少,
+// 读到 1 之后不会再变; acquire 栅栏与读者释放引用时的 release 同步, 之后可以安全地原地修改
+template <typename T>
+static bool exclusively_owned(const shared_ptr<T>& pointer) {
+    if (pointer.use_count() != 1) {
+        return false;
+    }
+    atomic_thread_fence(memory_order_acquire);
+    return true;
+}
+
+// 取得当前快照; 之后的读取和计算都不再持有锁
+template <typename C>
+shared_ptr<const typename BasicPolynomialWorkspace<C>::Snapshot> BasicPolynomialWorkspace<C>::current_snapshot() {
+    shared_lock<shared_mutex> lock(mutex_);
+    return snapshot_;
+}
+
+// 按名称查找: 名称表中的一次探测, 再按编号直接定位所在的块
+template <typename C>
+const BasicPolynomial<C>* BasicPolynomialWorkspace<C>::lookup(const Snapshot& snapshot, string_view name,
+                                                            uint64_t* version) {
+    uint32_t id = snapshot.names->find(name);
+    const Chunk* chunk = id == NameTable::NOT_FOUND ? nullptr : snapshot.chunks[id / CHUNK_SIZE].get();
+    uint64_t found = chunk != nullptr ? chunk->versions[id % CHUNK_SIZE] : 0;
+    if (version != nullptr) {
+        *version = found;
+    }
+    return found != 0 ? &chunk->polynomials[id % CHUNK_SIZE] : nullptr;
+}
+
+// 保存多项式; 快照、名称表或块被读者共享时先复制
+template <typename C>
+void BasicPolynomialWorkspace<C>::store(string_view name, BasicPolynomial<C>&& poly) {
+    if (!exclusively_owned(snapshot_)) {
+        snapshot_ = make_shared<Snapshot>(*snapshot_);
+    }
+    Snapshot& snapshot = *snapshot_;
+
+    uint32_t id = snapshot.names->find(name);
+    if (id == NameTable::NOT_FOUND) {
+        if (!exclusively_owned(snapshot.names)) {
+            snapshot.names = make_shared<NameTable>(*snapshot.names);
+        }
+        id = snapshot.names->intern(name);
+    }
+
+    size_t index = id / CHUNK_SIZE;
+    if (index == snapshot.chunks.size()) {
+        snapshot.chunks.push_back(make_shared<Chunk>());  // 编号连续, 新编号最多需要一个新块
+    } else if (!exclusively_owned(snapshot.chunks[index])) {
+        snapshot.chunks[index] = make_shared<Chunk>(*snapshot.chunks[index]);
+    }
+
+    Chunk& chunk = *snapshot.chunks[index];
+    if (chunk.versions[id % CHUNK_SIZE] == 0) {
+        ++snapshot.count;
+    }
+    chunk.polynomials[id % CHUNK_SIZE] = std::move(poly);
+    chunk.versions[id % CHUNK_SIZE] = ++next_version_;  // 引用旧版本的缓存条目不会再命中
+}
+
+// 生成缓存键, 例如 "la*b+a|3,7,3,"; 版本号区分同名多项式的不同内容, 不存在的多项式版本号为 0
+// 版本号取自计算所用的快照, 因此即使计算期间多项式被替换, 登记的结果也与键一致
+template <typename C>
+string BasicPolynomialWorkspace<C>::cache_key(const Snapshot& snapshot, char kind, const string& expr) {
+    string key(1, kind);
+    key.reserve(2 * expr.length() + 16);  // 版本号通常不超过名称本身的长度加一
+    for (char c : expr) {
+        if (c != ' ' && c != '\t') {
+            key += c;
+        }
+    }
+
+    key += '|';
+    for (size_t i = 0; i < expr.length(); ++i) {
+        if (!NameTable::is_identifier_start(expr[i])) {
+            continue;
+        }
+        size_t end = i + 1;
+        while (end < expr.length() && NameTable::is_identifier_char(expr[end])) {
+            ++end;
+        }
+        uint64_t version;
+        lookup(snapshot, string_view(expr).substr(i, end - i), &version);
+        key += to_string(version);
+        key += ',';
+        i = end - 1;
+    }
+    return key;
+}
+
+template <typename C>
+bool BasicPolynomialWorkspace<C>::find_cached(const string& key, string& result) {
+    lock_guard<mutex> lock(cache_mutex_);
+    return cache_.find(key, result);
+}
+
+template <typename C>
+void BasicPolynomialWorkspace<C>::store_cached(const string& key, const string& result) {
+    lock_guard<mutex> lock(cache_mutex_);
+    cache_.insert(key, result);
+}
+
+// 计算在锁外进行; 命中的结果移到最前, 键中的版本号保证不会取到过期的结果
+template <typename C>
+template <typename Compute>
+int BasicPolynomialWorkspace<C>::held_result(const string& key, Compute compute,
+                                             shared_ptr<const BasicPolynomial<C>>& result) {
+    {
+        lock_guard<mutex> lock(held_mutex_);
+        for (size_t i = 0; i < held_.size(); ++i) {
+            if (held_[i].first == key) {
+                rotate(held_.begin(), held_.begin() + i, held_.begin() + i + 1);
+                result = held_.front().second;
+                return 0;
+            }
+        }
+    }
+
+    shared_ptr<BasicPolynomial<C>> value = make_shared<BasicPolynomial<C>>();
+    int status = compute(*value);
+    if (status != 0) {
+        return status;
+    }
+
+    result = std::move(value);
+    lock_guard<mutex> lock(held_mutex_);
+    // 其他线程可能同时算出了同一个键, 先去掉旧的再放到最前
+    held_.erase(remove_if(held_.begin(), held_.end(),
+                          [&key](const pair<string, shared_ptr<const BasicPolynomial<C>>>& entry) {
+                              return entry.first == key;
+                          }),
+                held_.end());
+    held_.insert(held_.begin(), make_pair(key, result));
+    if (held_.size() > HELD_RESULTS) {
+        held_.pop_back();
+    }
+    return 0;
+}
+
+// 创建多项式
+template <typename C>
+int BasicPolynomialWorkspace<C>::create_polynomial(char name, const string& input) {
+    if (name < 'a' || name > 'e') {
+        return -1; // 不合法名称
+    }
+    return create_named_polynomial(string(1, name), input);
+}
+
+// 按名称创建多项式: 在锁外解析, 持有写锁时保存
+template <typename C>
+int BasicPolynomialWorkspace<C>::create_named_polynomial(const string& name, const string& input, size_t* error_offset) {
+    if (!NameTable::is_identifier(name)) {
+        return -1; // 不合法名称
+    }
+
+    BasicPolynomial<C> poly;
+    if (!poly.load_from_string(input, error_offset)) {
+        return -2; // 解析错误
+    }
+
+    unique_lock<shared_mutex> lock(mutex_);
+    store(name, std::move(poly));
+    return 0; // Success
+}
+
+// 由整数数组按名称创建多项式
+template <typename C>
+int BasicPolynomialWorkspace<C>::create_named_polynomial_from_terms(const string& name, const int64_t* coefficients,
+                                                                    const int64_t* exponents, size_t count, size_t stride,
+                                                                    bool canonical, size_t* error_index) {
+    if (!NameTable::is_identifier(name)) {
+        return -1; // 不合法名称
+    }
+
+    BasicPolynomial<C> poly;
+    if (!poly.load_terms(coefficients, exponents, count, stride, canonical, error_index)) {
+        return -2; // 数据不合法
+    }
+
+    unique_lock<shared_mutex> lock(mutex_);
+    store(name, std::move(poly));
+    return 0; // Success
+}
+
+// 获取多项式标准格式字符串
+template <typename C>
+int BasicPolynomialWorkspace<C>::get_polynomial_string(char name, string& result) {
+    if (name < 'a' || name > 'e') {
+        return -1; // 不合法名称
+    }
+    return get_named_polynomial_string(string(1, name), result);
+}
+
+// 按名称获取多项式标准格式字符串
+template <typename C>
+int BasicPolynomialWorkspace<C>::get_named_polynomial_string(const string& name, string& result) {
+    if (!NameTable::is_identifier(name)) {
+        return -1; // 不合法名称
+    }
+
+    shared_ptr<const Snapshot> snapshot = current_snapshot();
+    const BasicPolynomial<C>* poly = lookup(*snapshot, name);
+    if (poly == nullptr) {
+        return -2; // 多项式未找到
+    }
+
+    string key = cache_key(*snapshot, 'p', name);
+    if (find_cached(key, result)) {
+        return 0;
+    }
+
+    result = poly->to_standard_string();
+    store_cached(key, result);
+    return 0; // Success
+}
+
+// 按名称把多项式直接写入 out
+template <typename C>
+int BasicPolynomialWorkspace<C>::write_named_polynomial(const string& name, bool with_latex, TextWriter& out) {
+    if (!NameTable::is_identifier(name)) {
+        return -1; // 不合法名称
+    }
+
+    shared_ptr<const Snapshot> snapshot = current_snapshot();
+    const BasicPolynomial<C>* poly = lookup(*snapshot, name);
+    if (poly == nullptr) {
+        return -2; // 多项式未找到
+    }
+
+    poly->write_standard_string(out);
+    if (with_latex) {
+        out.append('|');
+        poly->write_latex_string(out);
+    }
+    return 0; // Success
+}
+
+// 把多项式的各项写入 64 位整数数组, 项数超过 capacity 时不写入
+template <typename C>
+static int export_terms(const BasicPolynomial<C>& poly, int64_t* coefficients, int64_t* exponents, size_t capacity,
+                        size_t stride, size_t& count) {
+    count = static_cast<size_t>(poly.get_term_count());
+    if (count > capacity) {
+        return 0;
+    }
+
+    size_t index = 0;
+    bool fits = true;
+    poly.for_each_term([&](const C& coeff, int exp) {
+        int64_t value = coefficient_traits<C>::to_int64(coeff);
+        if (coefficient_traits<C>::from_int64(value) != coeff) {
+            fits = false;
+        }
+        coefficients[index * stride] = value;
+        exponents[index * stride] = exp;
+        ++index;
+    });
+    return fits ? 0 : -3; // -3: 系数超出 int64 范围
+}
+
+// 按名称把多项式的各项写入整数数组
+template <typename C>
+int BasicPolynomialWorkspace<C>::get_named_polynomial_terms(const string& name, int64_t* coefficients, int64_t* exponents,
+                                                            size_t capacity, size_t stride, size_t& count) {
+    count = 0;
+    if (!NameTable::is_identifier(name)) {
+        return -1; // 不合法名称
+    }
+
+    shared_ptr<const Snapshot> snapshot = current_snapshot();
+    const BasicPolynomial<C>* poly = lookup(*snapshot, name);
+    if (poly == nullptr) {
+        return -2; // 多项式未找到
+    }
+
+    return export_terms(*poly, coefficients, exponents, capacity, stride, count);
+}
+
+// 获取多项式标准格式和LaTeX格式字符串
+template <typename C>
+int BasicPolynomialWorkspace<C>::get_polynomial_string_with_latex(char name, string& result) {
+    if (name < 'a' || name > 'e') {
+        return -1; // 不合法名称
+    }
+
+    shared_ptr<const Snapshot> snapshot = current_snapshot();
+    const BasicPolynomial<C>* poly = lookup(*snapshot, string_view(&name, 1));
+    if (poly == nullptr) {
+        return -2; // 多项式未找到
+    }
+
+    string key = cache_key(*snapshot, 'P', string(1, name));
+    if (find_cached(key, result)) {
+        return 0;
+    }
+
+    result = poly->to_standard_string() + "|" + poly->to_latex_string();
+    store_cached(key, result);
+    return 0; // Success
+}
+
+// 表达式求值使用的分配器, 每个线程一个, 每次求值后 reset 复用已申请的内存
+static PolynomialArena& evaluation_arena() {
+    static thread_local PolynomialArena arena;
+    return arena;
+}
+
+// 编译表达式, 出错时的返回值与逐字符求值的出错顺序一致
+template <typename C>
+int BasicPolynomialWorkspace<C>::compile_expression(const Snapshot& snapshot, const string& expr, ExpressionPlan& plan) {
+    int status = plan.compile(expr);
+    if (status != 0) {
+        for (const ExpressionPlan::Node& node : plan.nodes()) {
+            if (node.op == ExpressionPlan::LOAD && lookup(snapshot, plan.identifiers()[node.name]) == nullptr) {
+                return -5; // 未找到
+            }
+        }
+    }
+    return status;
+}
+
+// 解析多项式表达式并计算结果: 编译为表达式图后执行
+template <typename C>
+int BasicPolynomialWorkspace<C>::parse_expression(const Snapshot& snapshot, const string& expr,
+                                                BasicPolynomial<C>& result) {
+    static thread_local ExpressionPlan plan;  // 复用节点数组的内存
+    int status = compile_expression(snapshot, expr, plan);
+    if (status != 0) {
+        return status;
+    }
+    return execute_plan(snapshot, plan, result, nullptr);
+}
+
+template <typename C>
+int BasicPolynomialWorkspace<C>::parse_expression(const string& expr, BasicPolynomial<C>& result) {
+    shared_ptr<const Snapshot> snapshot = current_snapshot();
+    return parse_expression(*snapshot, expr, result);
+}
+
+// 执行编译后的表达式
+// 归约过程中的中间结果都从分配器中分配; 离开分配器作用域后再把最终结果复制到 result,
+// 使 result 使用普通堆内存, 然后整体回收分配器
+template <typename C>
+int BasicPolynomialWorkspace<C>::execute_plan(const Snapshot& snapshot, const ExpressionPlan& plan,
+                                            BasicPolynomial<C>& result, string* explain) {
+    PolynomialArena& arena = evaluation_arena();
+    int status;
+    {
+        BasicPolynomial<C> value;
+        {
+            ArenaScope scope(arena);
+            status = run_plan(snapshot, plan, value, explain);
+        }
+        if (status == 0) {
+            result = value;
+        }
+    }
+    arena.reset();
+    return status;
+}
+
+template <typename C>
+int BasicPolynomialWorkspace<C>::execute_plan(const ExpressionPlan& plan, BasicPolynomial<C>& result, string* explain) {
+    shared_ptr<const Snapshot> snapshot = current_snapshot();
+    return execute_plan(*snapshot, plan, result, explain);
+}
+
+// 节点的值: 读取的多项式只借用指针, 不复制; 运算产生的中间结果持有所有权,
+// 最后一次被引用时可以直接在其存储上原地运算
+template <typename C>
+struct ExpressionOperand {
+    const BasicPolynomial<C>* borrowed;  // 非空时指向快照中的多项式
+    BasicPolynomial<C> owned;            // borrowed 为空时的值
+
+    explicit ExpressionOperand(const BasicPolynomial<C>& registered) : borrowed(&registered) {}
+    explicit ExpressionOperand(BasicPolynomial<C>&& value) : borrowed(nullptr), owned(std::move(value)) {}
+
+    const BasicPolynomial<C>& get() const { return borrowed != nullptr ? *borrowed : owned; }
+};
+
+// 节点值数组: 内存来自分配器, 离开作用域时析构已构造的元素
+template <typename C>
+struct OperandSlots {
+    ExpressionOperand<C>* values;
+    size_t constructed;
+
+    ~OperandSlots() { destroy_n(values, constructed); }
+};
+
+// 执行过程的记录, 供 explain_expression 输出
+struct PlanExplain {
+    string* text;
+    vector<string> labels;  // 各节点的值的名称: 多项式名或 t1, t2, ...
+    int temps;
+
+    string next_temp() { return "t" + to_string(++temps); }
+};
+
+// 规划器使用的规模统计
+template <typename C>
+static OperandStats operand_stats(const BasicPolynomial<C>& poly) {
+    return {static_cast<double>(poly.get_term_count()), static_cast<long long>(poly.low_degree()),
+            static_cast<long long>(poly.degree())};
+}
+
+// 记录一次二元运算: "t1 = a * b  [3 x 2 terms -> 5 terms]", cost 非负时附带估计代价
+static void explain_step(PlanExplain* explain, const string& indent, const string& label, const string& lhs, char op,
+                         const string& rhs, double lhs_terms, double rhs_terms, double cost, int result_terms) {
+    string& text = *explain->text;
+    text += indent + label + " = " + lhs + " " + op + " " + rhs + "  [" + to_string(static_cast<long long>(lhs_terms));
+    text += op == '*' ? " x " : " + ";
+    text += to_string(static_cast<long long>(rhs_terms)) + " terms";
+    if (cost >= 0) {
+        text += ", est cost " + to_string(static_cast<long long>(cost));
+    }
+    text += " -> " + to_string(result_terms) + " terms]\n";
+}
+
+// 计算运算节点; remaining[k] 为节点 k 尚未被使用的引用次数
+// 操作数在这次使用后不再被引用且持有所有权时直接原地运算 (加法利用交换律, 右操作数也可以),
+// 两侧都不能修改时才分配新的结果; 不再被引用的中间结果随即释放
+template <typename C>
+static BasicPolynomial<C> evaluate_node(const ExpressionPlan::Node& node, ExpressionOperand<C>* values, int* remaining) {
+    ExpressionOperand<C>& lhs = values[node.lhs];
+
+    if (node.op == ExpressionPlan::SQUARE) {
+        BasicPolynomial<C> value = lhs.get().square();
+        if (--remaining[node.lhs] == 0) {
+            lhs.owned = BasicPolynomial<C>();
+        }
+        return value;
+    }
+
+    ExpressionOperand<C>& rhs = values[node.rhs];
+    remaining[node.lhs] -= 1;
+    remaining[node.rhs] -= 1;
+    bool consume_lhs = remaining[node.lhs] == 0 && lhs.borrowed == nullptr;
+    bool consume_rhs = remaining[node.rhs] == 0 && rhs.borrowed == nullptr && node.rhs != node.lhs;
+
+    BasicPolynomial<C> value;
+    switch (node.op) {
+        case '+':
+            if (consume_lhs) {
+                value = std::move(lhs.owned);
+                value += node.rhs == node.lhs ? value : rhs.get();
+            } else if (consume_rhs) {
+                value = std::move(rhs.owned);
+                value += lhs.get();
+            } else {
+                value = lhs.get() + rhs.get();
+            }
+            break;
+        case '-':
+            if (consume_lhs) {
+                value = std::move(lhs.owned);
+                value -= node.rhs == node.lhs ? value : rhs.get();
+            } else {
+                value = lhs.get() - rhs.get();
+            }
+            break;
+        default:
+            if (consume_lhs) {
+                value = std::move(lhs.owned);
+                value *= node.rhs == node.lhs ? value : rhs.get();
+            } else {
+                value = lhs.get() * rhs.get();
+            }
+            break;
+    }
+
+    if (remaining[node.lhs] == 0) {
+        lhs.owned = BasicPolynomial<C>();
+    }
+    if (remaining[node.rhs] == 0) {
+        rhs.owned = BasicPolynomial<C>();
+    }
+    return value;
+}
+
+// 链节点的操作数使用完毕, 不再被引用的中间结果随即释放
+template <typename C>
+static void release_chain_operands(const ExpressionPlan::ChainOperand* operands, size_t count,
+                                   ExpressionOperand<C>* values, int* remaining) {
+    for (size_t i = 0; i < count; ++i) {
+        if (--remaining[operands[i].node] == 0) {
+            values[operands[i].node].owned = BasicPolynomial<C>();
+        }
+    }
+}
+
+// 计算求和链: 所有操作数交给 BasicPolynomial::sum 一次合并
+template <typename C>
+static BasicPolynomial<C> evaluate_sum(const ExpressionPlan& plan, const ExpressionPlan::Node& node,
+                                       ExpressionOperand<C>* values, int* remaining, PlanExplain* explain) {
+    const ExpressionPlan::ChainOperand* operands = plan.chain_operands().data() + node.first;
+    size_t count = static_cast<size_t>(node.count);
+
+    PolynomialArena& arena = *PolynomialArena::current();
+    const BasicPolynomial<C>** polys = static_cast<const BasicPolynomial<C>**>(
+        arena.allocate(count * sizeof(const BasicPolynomial<C>*), alignof(const BasicPolynomial<C>*)));
+    int* signs = static_cast<int*>(arena.allocate(count * sizeof(int), alignof(int)));
+    for (size_t i = 0; i < count; ++i) {
+        polys[i] = &values[operands[i].node].get();
+        signs[i] = operands[i].sign;
+    }
+
+    BasicPolynomial<C> value = BasicPolynomial<C>::sum(polys, signs, count);
+
+    // "t1 = a - b + c  [3 + 2 + 1 terms -> 5 terms]"
+    if (explain != nullptr) {
+        string label = explain->next_temp();
+        string expr;
+        string sizes;
+        for (size_t i = 0; i < count; ++i) {
+            expr += i == 0 ? (signs[i] > 0 ? "" : "-") : (signs[i] > 0 ? " + " : " - ");
+            expr += explain->labels[operands[i].node];
+            sizes += (i > 0 ? " + " : "") + to_string(polys[i]->get_term_count());
+        }
+        *explain->text += label + " = " + expr + "  [" + sizes + " terms -> " + to_string(value.get_term_count()) + " terms]\n";
+        explain->labels.back() = label;
+    }
+
+    release_chain_operands(operands, count, values, remaining);
+    return value;
+}
+
+// 计算乘积链: 由 ExpressionPlan::order_chain 按操作数的实际规模选择结合顺序, 再依次合并
+// 结合顺序不影响结果 (系数环满足结合律和交换律)
+// 链的操作数只借用, 合并产生的中间结果持有所有权, 之后的合并在其上原地运算
+template <typename C>
+static BasicPolynomial<C> evaluate_product(const ExpressionPlan& plan, const ExpressionPlan::Node& node,
+                                           ExpressionOperand<C>* values, int* remaining, PlanExplain* explain) {
+    static thread_local vector<pair<int, int>> merges;  // 复用内存
+    const ExpressionPlan::ChainOperand* operands = plan.chain_operands().data() + node.first;
+    size_t count = static_cast<size_t>(node.count);
+
+    PolynomialArena& arena = *PolynomialArena::current();
+    OperandSlots<C> items{static_cast<ExpressionOperand<C>*>(
+        arena.allocate(count * sizeof(ExpressionOperand<C>), alignof(ExpressionOperand<C>))), 0};
+    OperandStats* stats = static_cast<OperandStats*>(arena.allocate(count * sizeof(OperandStats), alignof(OperandStats)));
+    for (size_t i = 0; i < count; ++i) {
+        new (items.values + i) ExpressionOperand<C>(values[operands[i].node].get());
+        ++items.constructed;
+        stats[i] = operand_stats(items.values[i].get());
+    }
+
+    double total = ExpressionPlan::order_chain(node.op, stats, count, merges);
+
+    vector<string> labels;
+    if (explain != nullptr) {
+        string& text = *explain->text;
+        text += string("chain ") + node.op + " (";
+        for (size_t i = 0; i < count; ++i) {
+            labels.push_back(explain->labels[operands[i].node]);
+            text += (i > 0 ? ", " : "") + labels[i];
+        }
+        text += "), est cost " + to_string(static_cast<long long>(total)) + "\n";
+    }
+
+    for (const pair<int, int>& merge : merges) {
+        ExpressionOperand<C>& lhs = items.values[merge.first];
+        ExpressionOperand<C>& rhs = items.values[merge.second];
+
+        BasicPolynomial<C> value;
+        if (lhs.borrowed == nullptr || rhs.borrowed == nullptr) {
+            ExpressionOperand<C>& target = lhs.borrowed == nullptr ? lhs : rhs;
+            const BasicPolynomial<C>& other = lhs.borrowed == nullptr ? rhs.get() : lhs.get();
+            value = std::move(target.owned);
+            value *= other;
+        } else {
+            value = lhs.get() * rhs.get();
+        }
+
+        if (explain != nullptr) {
+            OperandStats merged;
+            double cost = ExpressionPlan::estimate(node.op, stats[merge.first], stats[merge.second], merged);
+            string label = explain->next_temp();
+            explain_step(explain, "  ", label, labels[merge.first], node.op, labels[merge.second],
+                         stats[merge.first].terms, stats[merge.second].terms, cost, value.get_term_count());
+            labels[merge.first] = label;
+            stats[merge.first] = operand_stats(value);
+        }
+
+        lhs = ExpressionOperand<C>(std::move(value));
+        rhs.owned = BasicPolynomial<C>();
+    }
+
+    release_chain_operands(operands, count, values, remaining);
+    if (explain != nullptr) {
+        explain->labels.back() = labels[0];
+    }
+    return std::move(items.values[0].owned);
 }
 
-// 多项式加法
-Polynomial Polynomial::operator+(const Polynomial& other) const {
-    Polynomial result(cnt_ + other.cnt_);
-
-    for (int i = 0; i < cnt_; ++i) {
-        result.add_term(terms_[i]);
-    }
-    for (int i = 0; i < other.cnt_; ++i) {
-        result.add_term(other.terms_[i]);
+// 按拓扑序计算每个节点, 相同的子表达式只计算一次; 并入链节点的内部节点 (uses 为 0) 跳过
+// 节点值和引用计数放在当前分配器中 (execute_plan 总是先设置分配器)
+template <typename C>
+int BasicPolynomialWorkspace<C>::run_plan(const Snapshot& snapshot, const ExpressionPlan& plan, BasicPolynomial<C>& result,
+                                        string* explain) {
+    const vector<ExpressionPlan::Node>& nodes = plan.nodes();
+    if (plan.root() < 0) {
+        return -6; // 未成功编译
     }
 
-    return result;
-}
+    PolynomialArena& arena = *PolynomialArena::current();
+    OperandSlots<C> slots{static_cast<ExpressionOperand<C>*>(
+        arena.allocate(nodes.size() * sizeof(ExpressionOperand<C>), alignof(ExpressionOperand<C>))), 0};
+    int* remaining = static_cast<int*>(arena.allocate(nodes.size() * sizeof(int), alignof(int)));
+    PlanExplain record{explain, {}, 0};
+    PlanExplain* trace = explain != nullptr ? &record : nullptr;
+
+    for (size_t k = 0; k < nodes.size(); ++k) {
+        const ExpressionPlan::Node& node = nodes[k];
+        remaining[k] = node.uses;
+        if (trace != nullptr) {
+            trace->labels.emplace_back();
+        }
 
-// 多项式减法
-Polynomial Polynomial::operator-(const Polynomial& other) const {
-    Polynomial result(cnt_ + other.cnt_);
+        if (node.uses == 0) {
+            new (slots.values + k) ExpressionOperand<C>(BasicPolynomial<C>());
+        } else if (node.op == ExpressionPlan::LOAD) {
+            const BasicPolynomial<C>* poly = lookup(snapshot, plan.identifiers()[node.name]);
+            if (poly == nullptr) {
+                return -5; // 未找到
+            }
+            new (slots.values + k) ExpressionOperand<C>(*poly);
+            if (trace != nullptr) {
+                trace->labels[k] = plan.identifiers()[node.name];
+                *explain += trace->labels[k] + ": " + to_string(poly->get_term_count()) + " terms, degree " +
+                            to_string(static_cast<long long>(poly->low_degree())) + ".." +
+                            to_string(static_cast<long long>(poly->degree())) + "\n";
+            }
+        } else if (node.count > 0) {
+            BasicPolynomial<C> value = node.op == '+' ? evaluate_sum(plan, node, slots.values, remaining, trace)
+                                                      : evaluate_product(plan, node, slots.values, remaining, trace);
+            new (slots.values + k) ExpressionOperand<C>(std::move(value));
+        } else {
+            double lhs_terms = slots.values[node.lhs].get().get_term_count();
+            double rhs_terms = node.rhs >= 0 ? slots.values[node.rhs].get().get_term_count() : lhs_terms;
+            new (slots.values + k) ExpressionOperand<C>(evaluate_node(node, slots.values, remaining));
+            if (trace != nullptr) {
+                trace->labels[k] = trace->next_temp();
+                bool square = node.op == ExpressionPlan::SQUARE;
+                explain_step(trace, "", trace->labels[k], trace->labels[node.lhs], square ? '*' : node.op,
+                             trace->labels[square ? node.lhs : node.rhs], lhs_terms, rhs_terms, -1,
+                             slots.values[k].get().get_term_count());
+            }
+        }
+        ++slots.constructed;
+    }
 
-    for (int i = 0; i < cnt_; ++i) {
-        result.add_term(terms_[i]);
+    ExpressionOperand<C>& value = slots.values[plan.root()];
+    if (value.borrowed != nullptr) {
+        result = *value.borrowed;
+    } else {
+        result = std::move(value.owned);
     }
-    for (int i = 0; i < other.cnt_; ++i) {
-        result.add_term(Term(-other.terms_[i].get_coefficient(), other.terms_[i].get_exponent()));
+    if (trace != nullptr) {
+        *explain += "result = " + trace->labels[plan.root()] + "  [" + to_string(result.get_term_count()) + " terms]\n";
     }
-
-    return result;
+    return 0; // Success
 }
 
-// 多项式乘法
-Polynomial Polynomial::operator*(const Polynomial& other) const {
-    Polynomial result(cnt_ * other.cnt_ + 10);
+// 计算多项式表达式结果
+template <typename C>
+int BasicPolynomialWorkspace<C>::calculate_polynomials(const string& expr, string& result) {
+    shared_ptr<const Snapshot> snapshot = current_snapshot();
 
-    for (int i = 0; i < cnt_; ++i) {
-        for (int j = 0; j < other.cnt_; ++j) {
-            int new_coeff = terms_[i].get_coefficient() * other.terms_[j].get_coefficient();
-            int new_exp = terms_[i].get_exponent() + other.terms_[j].get_exponent();
-            result.add_term(Term(new_coeff, new_exp));
-        }
+    string key = cache_key(*snapshot, 's', expr);
+    if (find_cached(key, result)) {
+        return 0;
     }
 
-    return result;
-}
-
-Polynomial& Polynomial::operator+=(const Polynomial& other) {
-    *this = *this + other;
-    return *this;
-}
+    BasicPolynomial<C> poly_result;
+    int parse_result = parse_expression(*snapshot, expr, poly_result);
 
+    if (parse_result != 0) {
+        return parse_result;
+    }
 
-Polynomial& Polynomial::operator-=(const Polynomial& other) {
-    *this = *this - other;
-    return *this;
+    result = poly_result.to_standard_string();
+    store_cached(key, result);
+    return 0; // Success
 }
 
+// 计算多项式表达式结果并返回LaTeX格式
+template <typename C>
+int BasicPolynomialWorkspace<C>::calculate_polynomials_with_latex(const string& expr, string& result) {
+    shared_ptr<const Snapshot> snapshot = current_snapshot();
 
-Polynomial& Polynomial::operator*=(const Polynomial& other) {
-    *this = *this * other;
-    return *this;
-}
+    string key = cache_key(*snapshot, 'l', expr);
+    if (find_cached(key, result)) {
+        return 0;
+    }
 
-// 计算多项式在x处的值
-int Polynomial::evaluate(int x) const {
-    int result = 0;
+    BasicPolynomial<C> poly_result;
+    int parse_result = parse_expression(*snapshot, expr, poly_result);
 
-    for (int i = 0; i < cnt_; ++i) {
-        int term_value = terms_[i].get_coefficient();
-        for (int j = 0; j < terms_[i].get_exponent(); ++j) {
-            term_value *= x;
-        }
-        result += term_value;
+    if (parse_result != 0) {
+        return parse_result;
     }
 
-    return result;
+    result = poly_result.to_standard_string() + "|" + poly_result.to_latex_string();
+    store_cached(key, result);
+    return 0; // Success
 }
 
-// 计算多项式的导数
-Polynomial Polynomial::derivative() const {
-    Polynomial result(cnt_ + 5);
+// 计算多项式表达式并直接写入 out
+template <typename C>
+int BasicPolynomialWorkspace<C>::write_calculation(const string& expr, bool with_latex, TextWriter& out) {
+    shared_ptr<const Snapshot> snapshot = current_snapshot();
 
-    for (int i = 0; i < cnt_; ++i) {
-        if (terms_[i].get_exponent() > 0) {
-            int new_coeff = terms_[i].get_coefficient() * terms_[i].get_exponent();
-            int new_exp = terms_[i].get_exponent() - 1;
-            result.add_term(Term(new_coeff, new_exp));
-        }
+    shared_ptr<const BasicPolynomial<C>> poly_result;
+    int parse_result = held_result(
+        cache_key(*snapshot, 'e', expr),
+        [&](BasicPolynomial<C>& value) { return parse_expression(*snapshot, expr, value); }, poly_result);
 
+    if (parse_result != 0) {
+        return parse_result;
     }
 
-    return result;
+    poly_result->write_standard_string(out);
+    if (with_latex) {
+        out.append('|');
+        poly_result->write_latex_string(out);
+    }
+    return 0; // Success
 }
 
-// 转换为标准输出格式字符串
-string Polynomial::to_standard_string() const {
-    if (cnt_ == 0) {
-        return "0";
+// 计算多项式的导数并直接写入 out
+template <typename C>
+int BasicPolynomialWorkspace<C>::write_derivative(char name, bool with_latex, TextWriter& out) {
+    if (name < 'a' || name > 'e') {
+        return -1; // 不合法名称
     }
 
-    string result = to_string(cnt_);
-    for (int i = 0; i < cnt_; ++i) {
-        result += "," + to_string(terms_[i].get_coefficient()) + "," + to_string(terms_[i].get_exponent());
+    shared_ptr<const Snapshot> snapshot = current_snapshot();
+    const BasicPolynomial<C>* poly = lookup(*snapshot, string_view(&name, 1));
+    if (poly == nullptr) {
+        return -2; // 多项式未找到
     }
 
-    return result;
-}
+    shared_ptr<const BasicPolynomial<C>> derivative;
+    int status = held_result(
+        cache_key(*snapshot, 'g', string(1, name)),
+        [&](BasicPolynomial<C>& value) {
+            value = poly->derivative();
+            return 0;
+        },
+        derivative);
+
+    if (status != 0) {
+        return status;
+    }
 
-// 转换为LaTeX格式字符串
-string Polynomial::to_latex_string() const {
-    if (cnt_ == 0) {
-        return "0";
+    derivative->write_standard_string(out);
+    if (with_latex) {
+        out.append('|');
+        derivative->write_latex_string(out);
     }
+    return 0; // Success
+}
 
-    string result;
-    bool first = true;
+// 计算多项式表达式, 结果的各项写入整数数组
+template <typename C>
+int BasicPolynomialWorkspace<C>::calculate_polynomial_terms(const string& expr, int64_t* coefficients, int64_t* exponents,
+                                                            size_t capacity, size_t stride, size_t& count) {
+    count = 0;
+    shared_ptr<const Snapshot> snapshot = current_snapshot();
 
-    for (int i = 0; i < cnt_; ++i) {
-        int coeff = terms_[i].get_coefficient();
-        int exp = terms_[i].get_exponent();
+    shared_ptr<const BasicPolynomial<C>> poly_result;
+    int parse_result = held_result(
+        cache_key(*snapshot, 'e', expr),
+        [&](BasicPolynomial<C>& value) { return parse_expression(*snapshot, expr, value); }, poly_result);
 
-        if (!first) {
-            if (coeff > 0) {
-                result += " + ";
-            } else {
-                result += " - ";
-                coeff = -coeff;
-            }
-        } else {
-            if (coeff < 0) {
-                result += "-";
-                coeff = -coeff;
-            }
-            first = false;
-        }
-        if (coeff != 1 || exp == 0) {
-            result += to_string(coeff);
-        }
-        if (exp > 0) {
-            result += "x";
-            if (exp > 1) {
-                result += "^{" + to_string(exp) + "}";
-            }
-        }
+    if (parse_result != 0) {
+        return parse_result;
     }
 
-    return result;
+    return export_terms(*poly_result, coefficients, exponents, capacity, stride, count);
 }
 
-// 从字符串解析多项式
-void Polynomial::parse_from_string(const string& input) {
-    cnt_ = 0;
+// 计算表达式并返回执行过程的说明
+template <typename C>
+int BasicPolynomialWorkspace<C>::explain_expression(const string& expr, string& result) {
+    shared_ptr<const Snapshot> snapshot = current_snapshot();
 
-    if (input.empty()) {
-        return;
+    ExpressionPlan plan;
+    int status = compile_expression(*snapshot, expr, plan);
+    if (status != 0) {
+        return status;
     }
 
-    // 清理输入字符串
-    string clean_input = input;
-    clean_input.erase(remove_if(clean_input.begin(), clean_input.end(), ::isspace), clean_input.end());
+    BasicPolynomial<C> poly_result;
+    result.clear();
+    return execute_plan(*snapshot, plan, poly_result, &result);
+}
+
+// 执行编译后的表达式
+template <typename C>
+int BasicPolynomialWorkspace<C>::calculate_compiled(const ExpressionPlan& plan, string& result) {
+    shared_ptr<const Snapshot> snapshot = current_snapshot();
 
-    if (clean_input.empty()) {
-        return;
+    string key = cache_key(*snapshot, 's', plan.source());
+    if (find_cached(key, result)) {
+        return 0;
     }
 
-    // Parse "c1,e1,c2,e2,..." format
-    size_t start = 0;
-    size_t end = clean_input.find(',');
+    BasicPolynomial<C> poly_result;
+    int status = execute_plan(*snapshot, plan, poly_result, nullptr);
 
-    while (end != string::npos) {
-        string coeff_str = clean_input.substr(start, end - start);
+    if (status != 0) {
+        return status;
+    }
 
-        start = end + 1;
-        end = clean_input.find(',', start);
+    result = poly_result.to_standard_string();
+    store_cached(key, result);
+    return 0; // Success
+}
 
-        if (end == string::npos) {
-            string exp_str = clean_input.substr(start);
-            try {
-                int coeff = stoi(coeff_str);
-                int exp = stoi(exp_str);
-                add_term(Term(coeff, exp));
-            } catch (...) {
-                cnt_ = 0;
-                return;
-            }
-            break;
-        }
+// 执行编译后的表达式并返回LaTeX格式
+template <typename C>
+int BasicPolynomialWorkspace<C>::calculate_compiled_with_latex(const ExpressionPlan& plan, string& result) {
+    shared_ptr<const Snapshot> snapshot = current_snapshot();
 
-        string exp_str = clean_input.substr(start, end - start);
-        try {
-            int coeff = stoi(coeff_str);
-            int exp = stoi(exp_str);
-            add_term(Term(coeff, exp));
-        } catch (...) {
-            cnt_ = 0;
-            return;
-        }
+    string key = cache_key(*snapshot, 'l', plan.source());
+    if (find_cached(key, result)) {
+        return 0;
+    }
+
+    BasicPolynomial<C> poly_result;
+    int status = execute_plan(*snapshot, plan, poly_result, nullptr);
 
-        start = end + 1;
-        end = clean_input.find(',', start);
+    if (status != 0) {
+        return status;
     }
+
+    result = poly_result.to_standard_string() + "|" + poly_result.to_latex_string();
+    store_cached(key, result);
+    return 0; // Success
 }
 
-// ============================================================================
-// PolynomialManager类实现
-// ============================================================================
+// 计算多项式在x处的值
+template <typename C>
+int BasicPolynomialWorkspace<C>::evaluate_polynomial(char name, const C& x, C& result) {
+    if (name < 'a' || name > 'e') {
+        return -1; // 不合法名称
+    }
 
-mutex PolynomialManager::manager_mutex_;
-unordered_map<char, Polynomial> PolynomialManager::polynomials_;
-const int PolynomialManager::MAX_POLYNOMIALS = 5;
-const char PolynomialManager::POLYNOMIAL_NAMES[] = {'a', 'b', 'c', 'd', 'e'};
+    shared_ptr<const Snapshot> snapshot = current_snapshot();
+    const BasicPolynomial<C>* poly = lookup(*snapshot, string_view(&name, 1));
+    if (poly == nullptr) {
+        return -2; // 多项式未找到
+    }
 
-// 创建多项式
-int PolynomialManager::create_polynomial(char name, const string& input) {
-    lock_guard<mutex> lock(manager_mutex_);
+    result = poly->evaluate(x);
+    return 0; // Success
+}
 
+// 批量计算多项式在 xs[0..count) 处的值
+template <typename C>
+int BasicPolynomialWorkspace<C>::evaluate_polynomial_batch(char name, const C* xs, size_t count, C* results) {
     if (name < 'a' || name > 'e') {
         return -1; // 不合法名称
     }
 
-    if (polynomials_.size() >= MAX_POLYNOMIALS && polynomials_.find(name) == polynomials_.end()) {
-        return -3; // 超过多项式数量限制
+    shared_ptr<const Snapshot> snapshot = current_snapshot();
+    const BasicPolynomial<C>* poly = lookup(*snapshot, string_view(&name, 1));
+    if (poly == nullptr) {
+        return -2; // 多项式未找到
     }
 
-    try {
-        Polynomial poly(input);
-        polynomials_[name] = poly;
-        return 0; // Success
-    } catch (...) {
-        return -2; // 解析错误
-    }
+    poly->evaluate_batch(xs, count, results);
+    return 0; // Success
 }
 
-// 获取多项式标准格式字符串
-int PolynomialManager::get_polynomial_string(char name, string& result) {
-    lock_guard<mutex> lock(manager_mutex_);
-
+// 子乘积树多点求值
+template <typename C>
+int BasicPolynomialWorkspace<C>::evaluate_polynomial_multipoint(char name, const C* xs, size_t count, C* results) {
     if (name < 'a' || name > 'e') {
         return -1; // 不合法名称
     }
 
-    auto it = polynomials_.find(name);
-    if (it == polynomials_.end()) {
+    shared_ptr<const Snapshot> snapshot = current_snapshot();
+    const BasicPolynomial<C>* poly = lookup(*snapshot, string_view(&name, 1));
+    if (poly == nullptr) {
         return -2; // 多项式未找到
     }
 
-    result = it->second.to_standard_string();
+    poly->evaluate_multipoint(xs, count, results);
     return 0; // Success
 }
 
-// 获取多项式标准格式和LaTeX格式字符串
-int PolynomialManager::get_polynomial_string_with_latex(char name, string& result) {
-    lock_guard<mutex> lock(manager_mutex_);
-
+// 计算多项式的导数
+template <typename C>
+int BasicPolynomialWorkspace<C>::derivative_polynomial(char name, string& result) {
     if (name < 'a' || name > 'e') {
         return -1; // 不合法名称
     }
 
-    auto it = polynomials_.find(name);
-    if (it == polynomials_.end()) {
+    shared_ptr<const Snapshot> snapshot = current_snapshot();
+    const BasicPolynomial<C>* poly = lookup(*snapshot, string_view(&name, 1));
+    if (poly == nullptr) {
         return -2; // 多项式未找到
     }
 
-    result = it->second.to_standard_string() + "|" + it->second.to_latex_string();
+    string key = cache_key(*snapshot, 'd', string(1, name));
+    if (find_cached(key, result)) {
+        return 0;
+    }
+
+    BasicPolynomial<C> derivative = poly->derivative();
+    result = derivative.to_standard_string();
+    store_cached(key, result);
     return 0; // Success
 }
 
-// 解析多项式表达式并计算结果
-int PolynomialManager::parse_expression(const string& expr, Polynomial& result) {
-    if (expr.empty()) {
-        return -4; // 空表达式
+// 计算多项式的导数并返回LaTeX格式
+template <typename C>
+int BasicPolynomialWorkspace<C>::derivative_polynomial_with_latex(char name, string& result) {
+    if (name < 'a' || name > 'e') {
+        return -1; // 不合法名称
     }
 
-    Stack<Polynomial> poly_stack;
-    Stack<char> op_stack;
+    shared_ptr<const Snapshot> snapshot = current_snapshot();
+    const BasicPolynomial<C>* poly = lookup(*snapshot, string_view(&name, 1));
+    if (poly == nullptr) {
+        return -2; // 多项式未找到
+    }
 
-    for (size_t i = 0; i < expr.length(); ++i) {
-        char c = expr[i];
+    string key = cache_key(*snapshot, 'D', string(1, name));
+    if (find_cached(key, result)) {
+        return 0;
+    }
 
-        if (c >= 'a' && c <= 'e') {
-            auto it = polynomials_.find(c);
-            if (it == polynomials_.end()) {
-                return -5; // 未找到
-            }
-            poly_stack.push(it->second);
-        } else if (c == '+' || c == '-' || c == '*') {
-            while (!op_stack.empty() && op_stack.top() != '(' &&
-                   ((op_stack.top() == '*') || (op_stack.top() != '*' && c != '*'))) {
-                if (poly_stack.size() < 2) {
-                    return -6; 
-                }
+    BasicPolynomial<C> derivative = poly->derivative();
+    result = derivative.to_standard_string() + "|" + derivative.to_latex_string();
+    store_cached(key, result);
+    return 0; // Success
+}
 
-                char op = op_stack.top();
-                op_stack.pop();
-
-                Polynomial b = poly_stack.top();
-                poly_stack.pop();
-                Polynomial a = poly_stack.top();
-                poly_stack.pop();
-
-                switch (op) {
-                    case '+':
-                        poly_stack.push(a + b);
-                        break;
-                    case '-':
-                        poly_stack.push(a - b);
-                        break;
-                    case '*':
-                        poly_stack.push(a * b);
-                        break;
-                }
-            }
-            op_stack.push(c);
-        } else if (c == '(') {
-            op_stack.push(c);
-        } else if (c == ')') {
-            while (!op_stack.empty() && op_stack.top() != '(') {
-                if (poly_stack.size() < 2) {
-                    return -6;
-                }
+// 清除所有多项式: 替换为空快照, 正在进行的计算仍使用原来的快照
+template <typename C>
+void BasicPolynomialWorkspace<C>::clear_all() {
+    {
+        unique_lock<shared_mutex> lock(mutex_);
+        snapshot_ = make_shared<Snapshot>();
+    }
+    {
+        lock_guard<mutex> lock(held_mutex_);
+        held_.clear();
+    }
 
-                char op = op_stack.top();
-                op_stack.pop();
-
-                Polynomial b = poly_stack.top();
-                poly_stack.pop();
-                Polynomial a = poly_stack.top();
-                poly_stack.pop();
-
-                switch (op) {
-                    case '+':
-                        poly_stack.push(a + b);
-                        break;
-                    case '-':
-                        poly_stack.push(a - b);
-                        break;
-                    case '*':
-                        poly_stack.push(a * b);
-                        break;
-                }
-            }
-            if (op_stack.empty()) {
-                return -7; 
-            }
-            op_stack.pop(); 
-        } else if (c != ' ' && c != '\t') {
-            return -8; 
+    lock_guard<mutex> lock(cache_mutex_);
+    cache_.clear();
+}
+
+// 获取名称为 'a' - 'e' 的多项式
+template <typename C>
+int BasicPolynomialWorkspace<C>::get_polynomial_names(vector<char>& names) {
+    shared_ptr<const Snapshot> snapshot = current_snapshot();
+
+    names.clear();
+    for (uint32_t id = 0; id < snapshot->names->size(); ++id) {
+        string_view name = snapshot->names->name(id);
+        if (name.length() == 1 && name[0] >= 'a' && name[0] <= 'e' && snapshot->chunks[id / CHUNK_SIZE]->versions[id % CHUNK_SIZE] != 0) {
+            names.push_back(name[0]);
         }
     }
 
-    while (!op_stack.empty()) {
-        if (poly_stack.size() < 2) {
-            return -6; 
-        }
+    return static_cast<int>(names.size());
+}
+
+// 当前保存的多项式个数
+template <typename C>
+size_t BasicPolynomialWorkspace<C>::polynomial_count() {
+    return current_snapshot()->count;
+}
 
-        char op = op_stack.top();
-        op_stack.pop();
+// 设置结果缓存的内存预算
+template <typename C>
+void BasicPolynomialWorkspace<C>::set_cache_budget(size_t bytes) {
+    lock_guard<mutex> lock(cache_mutex_);
+    cache_.set_budget(bytes);
+}
 
-        Polynomial b = poly_stack.top();
-        poly_stack.pop();
-        Polynomial a = poly_stack.top();
-        poly_stack.pop();
+// 获取结果缓存的命中统计
+template <typename C>
+void BasicPolynomialWorkspace<C>::get_cache_stats(ResultCacheStats& stats) {
+    lock_guard<mutex> lock(cache_mutex_);
+    stats = cache_.stats();
+}
 
-        switch (op) {
-            case '+':
-                poly_stack.push(a + b);
-                break;
-            case '-':
-                poly_stack.push(a - b);
-                break;
-            case '*':
-                poly_stack.push(a * b);
-                break;
-        }
+// ============================================================================
+// 显式实例化
+// ============================================================================
+
+template class BasicTerm<int>;
+template class BasicPolynomial<int>;
+template class BasicPolynomialWorkspace<int>;
+template class BasicPolynomialManager<int>;
+template class BasicTerm<int64_t>;
+template class BasicPolynomial<int64_t>;
+template class BasicPolynomialWorkspace<int64_t>;
+template class BasicPolynomialManager<int64_t>;
+#if POLYNOMIAL_HAS_INT128
+template class BasicTerm<__int128>;
+template class BasicPolynomial<__int128>;
+template class BasicPolynomialWorkspace<__int128>;
+template class BasicPolynomialManager<__int128>;
+#endif
+template class BasicTerm<Zp>;
+template class BasicPolynomial<Zp>;
+template class BasicPolynomialWorkspace<Zp>;
+template class BasicPolynomialManager<Zp>;
+template class BasicTerm<BigInt>;
+template class BasicPolynomial<BigInt>;
+template class BasicPolynomialWorkspace<BigInt>;
+template class BasicPolynomialManager<BigInt>;
+
+// ============================================================================
+// PolynomialEngine实现
+// ============================================================================
+
+// 把类型擦除后的调用转发给对应系数类型的工作区
+template <typename C>
+class PolynomialEngineImpl : public PolynomialEngine {
+private:
+    unique_ptr<BasicPolynomialWorkspace<C>> owned_;  // 独立工作区, 使用默认工作区时为空
+    BasicPolynomialWorkspace<C>& workspace_;
+
+public:
+    // 使用该系数类型的默认工作区
+    PolynomialEngineImpl() : workspace_(BasicPolynomialManager<C>::default_workspace()) {}
+
+    // 使用独立的工作区, 随引擎一起释放
+    explicit PolynomialEngineImpl(unique_ptr<BasicPolynomialWorkspace<C>> owned)
+        : owned_(std::move(owned)), workspace_(*owned_) {}
+
+    int create_polynomial(char name, const string& input) override {
+        return workspace_.create_polynomial(name, input);
     }
 
-    if (poly_stack.size() != 1) {
-        return -6; // Expression error
+    int create_named_polynomial(const string& name, const string& input, size_t* error_offset) override {
+        return workspace_.create_named_polynomial(name, input, error_offset);
     }
 
-    result = poly_stack.top();
-    return 0; // Success
-}
+    int create_named_polynomial_from_terms(const string& name, const int64_t* coefficients, const int64_t* exponents,
+                                           size_t count, size_t stride, bool canonical, size_t* error_index) override {
+        return workspace_.create_named_polynomial_from_terms(name, coefficients, exponents, count, stride, canonical,
+                                                             error_index);
+    }
 
-// 计算多项式表达式结果
-int PolynomialManager::calculate_polynomials(const string& expr, string& result) {
-    lock_guard<mutex> lock(manager_mutex_);
+    int get_named_polynomial_string(const string& name, string& result) override {
+        return workspace_.get_named_polynomial_string(name, result);
+    }
 
-    Polynomial poly_result;
-    int parse_result = parse_expression(expr, poly_result);
+    int write_named_polynomial(const string& name, bool with_latex, TextWriter& out) override {
+        return workspace_.write_named_polynomial(name, with_latex, out);
+    }
 
-    if (parse_result != 0) {
-        return parse_result;
+    int get_named_polynomial_terms(const string& name, int64_t* coefficients, int64_t* exponents, size_t capacity,
+                                   size_t stride, size_t& count) override {
+        return workspace_.get_named_polynomial_terms(name, coefficients, exponents, capacity, stride, count);
     }
 
-    result = poly_result.to_standard_string();
-    return 0; // Success
-}
+    int write_calculation(const string& expr, bool with_latex, TextWriter& out) override {
+        return workspace_.write_calculation(expr, with_latex, out);
+    }
 
-// 计算多项式表达式结果并返回LaTeX格式
-int PolynomialManager::calculate_polynomials_with_latex(const string& expr, string& result) {
-    lock_guard<mutex> lock(manager_mutex_);
+    int write_derivative(char name, bool with_latex, TextWriter& out) override {
+        return workspace_.write_derivative(name, with_latex, out);
+    }
 
-    Polynomial poly_result;
-    int parse_result = parse_expression(expr, poly_result);
+    int calculate_polynomial_terms(const string& expr, int64_t* coefficients, int64_t* exponents, size_t capacity,
+                                   size_t stride, size_t& count) override {
+        return workspace_.calculate_polynomial_terms(expr, coefficients, exponents, capacity, stride, count);
+    }
 
-    if (parse_result != 0) {
-        return parse_result;
+    size_t polynomial_count() override {
+        return workspace_.polynomial_count();
     }
 
-    result = poly_result.to_standard_string() + "|" + poly_result.to_latex_string();
-    return 0; // Success
-}
+    int get_polynomial_string(char name, string& result) override {
+        return workspace_.get_polynomial_string(name, result);
+    }
 
-// 计算多项式在x处的值
-int PolynomialManager::evaluate_polynomial(char name, int x, int& result) {
-    lock_guard<mutex> lock(manager_mutex_);
+    int get_polynomial_string_with_latex(char name, string& result) override {
+        return workspace_.get_polynomial_string_with_latex(name, result);
+    }
 
-    if (name < 'a' || name > 'e') {
-        return -1; // 不合法名称
+    int calculate_polynomials(const string& expr, string& result) override {
+        return workspace_.calculate_polynomials(expr, result);
     }
 
-    auto it = polynomials_.find(name);
-    if (it == polynomials_.end()) {
-        return -2; // 多项式未找到
+    int calculate_polynomials_with_latex(const string& expr, string& result) override {
+        return workspace_.calculate_polynomials_with_latex(expr, result);
     }
 
-    result = it->second.evaluate(x);
-    return 0; // Success
-}
+    int calculate_compiled(const ExpressionPlan& plan, string& result) override {
+        return workspace_.calculate_compiled(plan, result);
+    }
 
-// 计算多项式的导数
-int PolynomialManager::derivative_polynomial(char name, string& result) {
-    lock_guard<mutex> lock(manager_mutex_);
+    int calculate_compiled_with_latex(const ExpressionPlan& plan, string& result) override {
+        return workspace_.calculate_compiled_with_latex(plan, result);
+    }
 
-    if (name < 'a' || name > 'e') {
-        return -1; // 不合法名称
+    int explain_expression(const string& expr, string& result) override {
+        return workspace_.explain_expression(expr, result);
     }
 
-    auto it = polynomials_.find(name);
-    if (it == polynomials_.end()) {
-        return -2; // 多项式未找到
+    int evaluate_polynomial(char name, int x, int& result) override {
+        C value;
+        int code = workspace_.evaluate_polynomial(name, coefficient_traits<C>::from_int64(x), value);
+        if (code == 0) {
+            result = static_cast<int>(coefficient_traits<C>::to_int64(value));
+        }
+        return code;
     }
 
-    Polynomial derivative = it->second.derivative();
-    result = derivative.to_standard_string();
-    return 0; // Success
-}
+    int evaluate_polynomial(char name, int x, string& result) override {
+        C value;
+        int code = workspace_.evaluate_polynomial(name, coefficient_traits<C>::from_int64(x), value);
+        if (code == 0) {
+            result = coefficient_traits<C>::to_string(value);
+        }
+        return code;
+    }
 
-// 计算多项式的导数并返回LaTeX格式
-int PolynomialManager::derivative_polynomial_with_latex(char name, string& result) {
-    lock_guard<mutex> lock(manager_mutex_);
+    int evaluate_polynomial_batch(char name, const int* xs, int count, int* results) override {
+        vector<C> points(static_cast<size_t>(count)), values(static_cast<size_t>(count));
+        for (int i = 0; i < count; ++i) {
+            points[i] = coefficient_traits<C>::from_int64(xs[i]);
+        }
+        int code = workspace_.evaluate_polynomial_batch(name, points.data(), points.size(), values.data());
+        if (code == 0) {
+            for (int i = 0; i < count; ++i) {
+                results[i] = static_cast<int>(coefficient_traits<C>::to_int64(values[i]));
+            }
+        }
+        return code;
+    }
 
-    if (name < 'a' || name > 'e') {
-        return -1; // 不合法名称
+    int derivative_polynomial(char name, string& result) override {
+        return workspace_.derivative_polynomial(name, result);
     }
 
-    auto it = polynomials_.find(name);
-    if (it == polynomials_.end()) {
-        return -2; // 多项式未找到
+    int derivative_polynomial_with_latex(char name, string& result) override {
+        return workspace_.derivative_polynomial_with_latex(name, result);
     }
 
-    Polynomial derivative = it->second.derivative();
-    result = derivative.to_standard_string() + "|" + derivative.to_latex_string();
-    return 0; // Success
+    void clear_all() override {
+        workspace_.clear_all();
+    }
+
+    int get_polynomial_names(vector<char>& names) override {
+        return workspace_.get_polynomial_names(names);
+    }
+
+    void set_cache_budget(size_t bytes) override {
+        workspace_.set_cache_budget(bytes);
+    }
+
+    void get_cache_stats(ResultCacheStats& stats) override {
+        workspace_.get_cache_stats(stats);
+    }
+};
+
+// 当前选择的系数类型, 默认 int
+static atomic<int> active_kind_(COEFFICIENT_INT32);
+
+PolynomialEngine* polynomial_engine(int kind) {
+    static PolynomialEngineImpl<int> int32_engine;
+    static PolynomialEngineImpl<int64_t> int64_engine;
+#if POLYNOMIAL_HAS_INT128
+    static PolynomialEngineImpl<__int128> int128_engine;
+#endif
+    static PolynomialEngineImpl<Zp> modular_engine;
+    static PolynomialEngineImpl<BigInt> bigint_engine;
+
+    switch (kind) {
+        case COEFFICIENT_INT32:
+            return &int32_engine;
+        case COEFFICIENT_INT64:
+            return &int64_engine;
+#if POLYNOMIAL_HAS_INT128
+        case COEFFICIENT_INT128:
+            return &int128_engine;
+#endif
+        case COEFFICIENT_MODULAR:
+            return &modular_engine;
+        case COEFFICIENT_BIGINT:
+            return &bigint_engine;
+        default:
+            return nullptr;
+    }
 }
 
-// 清除所有多项式
-void PolynomialManager::clear_all() {
-    lock_guard<mutex> lock(manager_mutex_);
-    polynomials_.clear();
+template <typename C>
+static PolynomialEngine* new_workspace_engine() {
+    return new PolynomialEngineImpl<C>(make_unique<BasicPolynomialWorkspace<C>>());
 }
 
-// 获取所有多项式名称
-int PolynomialManager::get_polynomial_names(vector<char>& names) {
-    lock_guard<mutex> lock(manager_mutex_);
+PolynomialEngine* create_polynomial_engine(int kind) {
+    switch (kind) {
+        case COEFFICIENT_INT32:
+            return new_workspace_engine<int>();
+        case COEFFICIENT_INT64:
+            return new_workspace_engine<int64_t>();
+#if POLYNOMIAL_HAS_INT128
+        case COEFFICIENT_INT128:
+            return new_workspace_engine<__int128>();
+#endif
+        case COEFFICIENT_MODULAR:
+            return new_workspace_engine<Zp>();
+        case COEFFICIENT_BIGINT:
+            return new_workspace_engine<BigInt>();
+        default:
+            return nullptr;
+    }
+}
 
-    names.clear();
-    for (const auto& pair : polynomials_) {
-        names.push_back(pair.first);
+int set_active_coefficient_kind(int kind) {
+    if (polynomial_engine(kind) == nullptr) {
+        return -1; // 不可用的系数类型
     }
+    active_kind_.store(kind);
+    return 0;
+}
 
-    return static_cast<int>(names.size());
+int active_coefficient_kind() {
+    return active_kind_.load();
+}
+
+// 当前线程临时使用的引擎 (工作区), 为空时使用当前选择的系数类型
+static thread_local PolynomialEngine* scoped_engine_ = nullptr;
+
+PolynomialEngine& active_polynomial_engine() {
+    return scoped_engine_ != nullptr ? *scoped_engine_ : *polynomial_engine(active_kind_.load());
+}
+
+ScopedPolynomialEngine::ScopedPolynomialEngine(PolynomialEngine* engine) : previous_(scoped_engine_) {
+    scoped_engine_ = engine;
+}
+
+ScopedPolynomialEngine::~ScopedPolynomialEngine() {
+    scoped_engine_ = previous_;
 }
 
 // ============================================================================
@@ -663,7 +3090,7 @@ int PolynomialManager::get_polynomial_names(vector<char>& names) {
 extern "C" int get_polynomial_string_with_latex(char name, char* output, int buffer_size) {
     try {
         string result;
-        int code = PolynomialManager::get_polynomial_string_with_latex(name, result);
+        int code = active_polynomial_engine().get_polynomial_string_with_latex(name, result);
         if (code == 0 && result.length() < static_cast<size_t>(buffer_size)) {
             strcpy(output, result.c_str());
         }
@@ -677,7 +3104,7 @@ extern "C" int get_polynomial_string_with_latex(char name, char* output, int buf
 extern "C" int calculate_polynomials_with_latex(const char* expression, char* output, int buffer_size) {
     try {
         string result;
-        int code = PolynomialManager::calculate_polynomials_with_latex(string(expression), result);
+        int code = active_polynomial_engine().calculate_polynomials_with_latex(string(expression), result);
         if (code == 0 && result.length() < static_cast<size_t>(buffer_size)) {
             strcpy(output, result.c_str());
         }
@@ -690,7 +3117,7 @@ extern "C" int calculate_polynomials_with_latex(const char* expression, char* ou
 extern "C" int derivative_polynomial_with_latex(char name, char* output, int buffer_size) {
     try {
         string result;
-        int code = PolynomialManager::derivative_polynomial_with_latex(name, result);
+        int code = active_polynomial_engine().derivative_polynomial_with_latex(name, result);
         if (code == 0 && result.length() < static_cast<size_t>(buffer_size)) {
             strcpy(output, result.c_str());
         }
@@ -698,4 +3125,33 @@ extern "C" int derivative_polynomial_with_latex(char name, char* output, int buf
     } catch (...) {
         return -1;
     }
+}
+
+// 以上三个接口的工作区版本, workspace 为 create_polynomial_workspace 返回的句柄
+
+extern "C" int workspace_get_polynomial_string_with_latex(PolynomialEngine* workspace, char name, char* output,
+                                                          int buffer_size) {
+    if (!workspace) {
+        return -3; // ERROR_INVALID_INPUT, 与 calc_polynomial.cpp 的 workspace_ 接口相同
+    }
+    ScopedPolynomialEngine scope(workspace);
+    return get_polynomial_string_with_latex(name, output, buffer_size);
+}
+
+extern "C" int workspace_calculate_polynomials_with_latex(PolynomialEngine* workspace, const char* expression,
+                                                          char* output, int buffer_size) {
+    if (!workspace) {
+        return -3; // ERROR_INVALID_INPUT, 与 calc_polynomial.cpp 的 workspace_ 接口相同
+    }
+    ScopedPolynomialEngine scope(workspace);
+    return calculate_polynomials_with_latex(expression, output, buffer_size);
+}
+
+extern "C" int workspace_derivative_polynomial_with_latex(PolynomialEngine* workspace, char name, char* output,
+                                                          int buffer_size) {
+    if (!workspace) {
+        return -3; // ERROR_INVALID_INPUT, 与 calc_polynomial.cpp 的 workspace_ 接口相同
+    }
+    ScopedPolynomialEngine scope(workspace);
+    return derivative_polynomial_with_latex(name, output, buffer_size);
 }
\ No newline at end of file
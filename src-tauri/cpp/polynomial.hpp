@@ -6,48 +6,239 @@
 #include <algorithm>
 #include <sstream>
 #include <mutex>
+#include <shared_mutex>
 #include <unordered_map>
 #include <stdexcept>
+#include <cstring>
+#include <type_traits>
+
+#include "coefficient.hpp"
+#include "expression_plan.hpp"
+#include "name_table.hpp"
+#include "result_cache.hpp"
 
 using namespace std;
 
-// Term类: 表示多项式中的单项式
-class Term {
+// BasicTerm类: 表示多项式中的单项式, C 为系数类型, E 为指数类型
+template <typename C, typename E = int>
+class BasicTerm {
 private:
-    int coefficient_;  // 系数
-    int exponent_;     // 指数
+    C coefficient_;  // 系数
+    E exponent_;     // 指数
 
 public:
 
-    Term(int coefficient = 0, int exponent = 0);
+    BasicTerm(const C& coefficient = C(), E exponent = 0);
 
-    int get_coefficient() const { return coefficient_; }
-    int get_exponent() const { return exponent_; }
+    const C& get_coefficient() const { return coefficient_; }
+    E get_exponent() const { return exponent_; }
 
-    void set_coefficient(int coefficient) { coefficient_ = coefficient; }
-    void set_exponent(int exponent) { exponent_ = exponent; }
+    void set_coefficient(const C& coefficient) { coefficient_ = coefficient; }
+    void set_exponent(E exponent) { exponent_ = exponent; }
 
-    bool operator<(const Term& other) const {
+    bool operator<(const BasicTerm& other) const {
         return exponent_ > other.exponent_; // Sort by exponent descending
     }
 
-    bool operator==(const Term& other) const {
+    bool operator==(const BasicTerm& other) const {
         return exponent_ == other.exponent_;
     }
 
     string to_string() const;
 };
 
-// Polynomial类: 表示多项式及其操作
-class Polynomial {
+// 文本输出: 写入调用方的缓冲区 (与 snprintf 相同, 超出容量的部分只计入长度, 据此可以先求出完整长度再分配),
+// 或追加到字符串末尾; 数字用 to_chars 直接写入, 不生成临时字符串
+class TextWriter {
+private:
+    char* out_;
+    size_t limit_;     // 缓冲区中可写的字符数 (容量减去结尾的 '\0')
+    size_t length_;    // 完整结果的长度
+    string* target_;   // 非空时追加到该字符串
+
+public:
+    // out 的容量为 capacity 字节 (含结尾的 '\0'), capacity 为 0 时 out 可以为空, 只计算长度
+    TextWriter(char* out, size_t capacity)
+        : out_(out), limit_(capacity == 0 ? 0 : capacity - 1), length_(0), target_(nullptr) {}
+
+    explicit TextWriter(string& target) : out_(nullptr), limit_(0), length_(0), target_(&target) {}
+
+    void append(const char* data, size_t size) {
+        if (target_) {
+            target_->append(data, size);
+        } else if (length_ < limit_) {
+            memcpy(out_ + length_, data, min(size, limit_ - length_));
+        }
+        length_ += size;
+    }
+
+    void append(string_view text) { append(text.data(), text.size()); }
+
+    void append(char c) { append(&c, 1); }
+
+    template <typename T>
+    void append_number(const T& value) {
+        if constexpr (is_integral<T>::value && sizeof(T) <= sizeof(int64_t)) {
+            char digits[24];
+            char* end = to_chars(digits, digits + sizeof(digits), value).ptr;
+            append(digits, static_cast<size_t>(end - digits));
+        } else {
+            append(coefficient_traits<T>::to_string(value));
+        }
+    }
+
+    template <uint32_t MOD>
+    void append_number(const ModInt<MOD>& value) {
+        append_number(value.value());
+    }
+
+    size_t length() const { return length_; }
+
+    // 在缓冲区中写入结尾的 '\0' (长度超出容量时写在最后一个字节, 此时缓冲区中为截断的前缀)
+    void finish() {
+        if (!target_ && out_ != nullptr) {
+            out_[min(length_, limit_)] = '\0';
+        }
+    }
+};
+
+// 写时复制的数组: 复制时只增加引用计数, 共享同一个 vector; 只读接口直接访问,
+// 修改必须通过 mutate(), 此时若与其他对象共享则先复制一份
+template <typename T>
+class SharedVector {
 private:
-    Term *terms_;     // 项列表
-    int cnt_;         // 项数量
-    size_t capacity_; // 数组容量
+    shared_ptr<vector<T>> data_;  // 空指针表示空数组
+
+    static const vector<T>& empty_vector() {
+        static const vector<T> empty;
+        return empty;
+    }
+
+public:
+    SharedVector() = default;
+
+    size_t size() const { return data_ ? data_->size() : 0; }
+    size_t capacity() const { return data_ ? data_->capacity() : 0; }
+    bool empty() const { return size() == 0; }
+    const T& operator[](size_t index) const { return (*data_)[index]; }
+    const T& back() const { return data_->back(); }
+    const T* data() const { return data_ ? data_->data() : nullptr; }
+    const vector<T>& get() const { return data_ ? *data_ : empty_vector(); }
+
+    // 可写的数组, 被共享时先复制
+    vector<T>& mutate() {
+        if (!data_) {
+            data_ = make_shared<vector<T>>();
+        } else if (data_.use_count() > 1) {
+            data_ = make_shared<vector<T>>(*data_);
+        }
+        return *data_;
+    }
+
+    // 整体替换为 values
+    void assign(vector<T>&& values) {
+        if (data_ && data_.use_count() == 1) {
+            *data_ = std::move(values);
+        } else {
+            data_ = make_shared<vector<T>>(std::move(values));
+        }
+    }
+
+    // 放弃对数组的引用
+    void release() { data_.reset(); }
+};
+
+// BasicPolynomial类: 表示多项式及其操作, C 为系数类型, E 为指数类型
+// 两种存储方式:
+//  - 稀疏: coeffs_ / exps_ 两个并列数组 (SoA) 按指数降序保存非零项, 便于整段向量化处理
+//    项数不超过 INLINE_TERMS 时放在对象内部的内联数组中, 超过后才申请堆内存
+//    表达式求值期间的临时多项式从 PolynomialArena 分配 (见 parse_expression)
+//  - 稠密: dense_[e] 为 x^e 的系数, 仅在所有指数非负且填充率较高时使用
+// 每次修改后根据填充率自动在两者之间切换, cnt_ 始终为非零项个数
+// 堆上的稀疏数组块和稠密数组带引用计数: 复制多项式时共享, 修改前若被共享才复制 (写时复制),
+// 因此复制、入栈、取出管理器中的多项式都是 O(1); 内联存储和 PolynomialArena 中的数组复制时仍逐项复制
+template <typename C, typename E = int>
+class BasicPolynomial {
+public:
+    using Term = BasicTerm<C, E>;
+
+    // 内联存储的项数: 常数、单项式等小多项式不申请堆内存
+    static constexpr size_t INLINE_TERMS = 4;
+
+private:
+    C *coeffs_;        // 系数数组 (稀疏存储), 指向 inline_coeffs_ 或堆上的内存块 (可能与其他多项式共享)
+    E *exps_;          // 指数数组 (稀疏存储), 与 coeffs_ 一一对应
+    int cnt_;          // 项数量
+    size_t capacity_;  // 数组容量
+    SharedVector<C> dense_;  // 系数数组 (稠密存储), 最高位系数非零
+    bool is_dense_;    // 当前是否为稠密存储
+    bool arena_block_; // coeffs_ / exps_ 所在的内存块是否来自 PolynomialArena (释放时不归还)
+    C inline_coeffs_[INLINE_TERMS];  // 内联存储
+    E inline_exps_[INLINE_TERMS];
+
+    bool uses_inline_terms() const { return coeffs_ == inline_coeffs_; }
+
+    // 接管 other 的内容 (移动构造 / 移动赋值)
+    void steal_from(BasicPolynomial& other) noexcept;
+
+    // 复制 other 的内容 (复制构造 / 复制赋值), 堆上的数组共享而不复制
+    void copy_from(const BasicPolynomial& other);
+
+    // 稀疏数组是否与其他多项式共享
+    bool shares_terms() const;
+
+    // 修改稀疏数组之前调用: 被共享时换成独占的副本
+    void make_terms_unique();
+
+    // 分配 / 释放系数和指数数组, 容量不超过 INLINE_TERMS 时使用内联存储
+    void allocate_terms(size_t capacity);
+    void release_terms();
+
+    // 换到容量为 new_capacity 的新数组, 保留已有项
+    void reallocate(size_t new_capacity);
 
     // 扩容
     void resize_if_needed();
 
+    // 预留至少 min_capacity 的容量, 保留已有项
+    void reserve(size_t min_capacity);
+
+    // 双指针归并两个有序多项式, sign = 1 为加法, -1 为减法
+    static BasicPolynomial merge(const BasicPolynomial& lhs, const BasicPolynomial& rhs, int sign);
+
+    // 原地归并 (用于 += / -=), 从尾部向前写入避免额外缓冲区
+    void merge_in_place(const BasicPolynomial& other, int sign);
+
+    // += / -= 的入口, 按两侧的存储方式选择稠密累加或稀疏归并
+    void add_in_place(const BasicPolynomial& other, int sign);
+
+    // 在尾部追加一项 (调用方保证指数严格递减且系数非零)
+    void append_term(const C& coefficient, E exponent);
+
+    // 两个稀疏多项式相乘, 按乘积指数跨度选择累加或堆归并
+    static BasicPolynomial multiply_sparse(const BasicPolynomial& lhs, const BasicPolynomial& rhs);
+
+    // 稀疏乘法: 堆归并 min(n, m) 条部分积流, 按指数降序直接输出
+    static BasicPolynomial multiply_heap(const BasicPolynomial& lhs, const BasicPolynomial& rhs);
+
+    // 稀疏多项式的平方, 按指数跨度选择累加或堆归并, 交叉项只计算一次
+    static BasicPolynomial square_sparse(const BasicPolynomial& poly);
+
+    // 稀疏多项式乘单项式 coeff * x^exp
+    static BasicPolynomial multiply_monomial(const BasicPolynomial& poly, const C& coeff, E exp);
+
+    // 稠密累加乘法: 乘积指数跨度较小时用数组按指数累加
+    static BasicPolynomial multiply_accumulate(const BasicPolynomial& lhs, const BasicPolynomial& rhs);
+
+    // 稠密 x 稠密: 系数数组卷积
+    static BasicPolynomial multiply_dense(const BasicPolynomial& lhs, const BasicPolynomial& rhs);
+
+    // 稠密 x 稀疏: 对稀疏的每一项把稠密数组平移累加
+    static BasicPolynomial multiply_dense_sparse(const BasicPolynomial& dense, const BasicPolynomial& sparse);
+
+    // 由系数数组构造多项式 (coeffs[e] 为 x^e 的系数)
+    static BasicPolynomial from_dense(vector<C>&& coeffs);
+
     // 排序项
     void sort_terms();
 
@@ -57,98 +248,557 @@ private:
     // 移除系数为零的项
     void remove_zero_terms();
 
+    // 最高 / 最低指数 (要求非零多项式)
+    E max_exponent() const;
+    E min_exponent() const;
+
+    // 判断与 other 的和是否适合用稠密数组计算
+    bool fits_dense_with(const BasicPolynomial& other) const;
+
+    // 存储方式转换
+    void to_dense();
+    void to_sparse();
+
+    // 返回稀疏存储的副本
+    BasicPolynomial sparse_copy() const;
+
+    // 去掉稠密数组高位的零并重新统计非零项个数
+    void normalize_dense();
+
+    // 根据填充率选择存储方式
+    void update_representation();
+
+    // 同时在 count (<= LANES) 个点上求值
+    template <size_t LANES>
+    void evaluate_lanes(const C* xs, size_t count, C* out) const;
+
 public:
 
-    explicit Polynomial(size_t capacity = 10);
+    explicit BasicPolynomial(size_t capacity = INLINE_TERMS);
+
 
+    explicit BasicPolynomial(const string& input, size_t capacity = INLINE_TERMS);
 
-    explicit Polynomial(const string& input, size_t capacity = 10);
 
+    BasicPolynomial(const Term* terms, int count, size_t capacity = INLINE_TERMS);
 
-    Polynomial(const Term* terms, int count, size_t capacity = 10);
+    BasicPolynomial(const BasicPolynomial& other);
 
-    Polynomial(const Polynomial& other);
 
+    BasicPolynomial(BasicPolynomial&& other) noexcept;
 
-    Polynomial(Polynomial&& other) noexcept;
+    BasicPolynomial& operator=(const BasicPolynomial& other);
 
-    Polynomial& operator=(const Polynomial& other);
 
- 
-    Polynomial& operator=(Polynomial&& other) noexcept;
+    BasicPolynomial& operator=(BasicPolynomial&& other) noexcept;
 
-    ~Polynomial();
+    ~BasicPolynomial();
 
 
     void add_term(const Term& term);
 
     int get_term_count() const { return cnt_; }
 
-    const Term& get_term(int index) const;
+    // 按指数降序的第 index 个非零项
+    Term get_term(int index) const;
 
     bool is_zero() const { return cnt_ == 0; }
 
-    size_t capacity() const { return capacity_; }
+    bool is_dense() const { return is_dense_; }
+
+    // 最高次数, 零多项式为 0
+    E degree() const { return cnt_ == 0 ? 0 : max_exponent(); }
+
+    // 最低次数, 零多项式为 0
+    E low_degree() const { return cnt_ == 0 ? 0 : min_exponent(); }
+
+    size_t capacity() const { return is_dense_ ? dense_.capacity() : capacity_; }
+
+    // 按指数降序遍历所有非零项, f(coefficient, exponent)
+    template <typename F>
+    void for_each_term(F f) const {
+        if (is_dense_) {
+            for (E e = static_cast<E>(dense_.size()) - 1; e >= 0; --e) {
+                if (dense_[e] != C()) {
+                    f(dense_[e], e);
+                }
+            }
+        } else {
+            for (int i = 0; i < cnt_; ++i) {
+                f(coeffs_[i], exps_[i]);
+            }
+        }
+    }
 
     // 重载多项式运算符
-    Polynomial operator+(const Polynomial& other) const;
+    BasicPolynomial operator+(const BasicPolynomial& other) const;
+
+    BasicPolynomial operator-(const BasicPolynomial& other) const;
+
+    BasicPolynomial operator*(const BasicPolynomial& other) const;
 
-    Polynomial operator-(const Polynomial& other) const;
+    BasicPolynomial& operator+=(const BasicPolynomial& other);
 
-    Polynomial operator*(const Polynomial& other) const;
+    BasicPolynomial& operator-=(const BasicPolynomial& other);
 
-    Polynomial& operator+=(const Polynomial& other);
+    BasicPolynomial& operator*=(const BasicPolynomial& other);
 
-    Polynomial& operator-=(const Polynomial& other);
+    // 代数和 signs[0] * operands[0] + ... + signs[count-1] * operands[count-1], signs[k] 为 1 或 -1
+    // 所有操作数一次合并 (数组累加或 count 路堆归并), 不逐对生成中间结果
+    static BasicPolynomial sum(const BasicPolynomial* const* operands, const int* signs, size_t count);
 
-    Polynomial& operator*=(const Polynomial& other);
+    // 平方, 结果与 *this * *this 相同; 交叉项 c_i c_j (i != j) 只计算一次
+    BasicPolynomial square() const;
 
     // 计算多项式在x处的值
-    int evaluate(int x) const;
+    C evaluate(const C& x) const;
+
+    // 批量求值: results[i] = p(xs[i]), 点数较多且适合时自动改用子乘积树
+    void evaluate_batch(const C* xs, size_t count, C* results) const;
+
+    // 多点求值: 子乘积树 + 快速取余, O(M(n) log n); 含负指数时退回逐点求值
+    void evaluate_multipoint(const C* xs, size_t count, C* results) const;
 
     // 计算多项式的导数
-    Polynomial derivative() const;
+    BasicPolynomial derivative() const;
 
     // 转换为标准输出格式字符串
     string to_standard_string() const;
     // 转换为LaTeX格式字符串
     string to_latex_string() const;
 
-    void clear() { cnt_ = 0; }
+    // 把标准格式 / LaTeX 格式写入 out, 与 to_standard_string / to_latex_string 的结果相同
+    void write_standard_string(TextWriter& out) const;
+    void write_latex_string(TextWriter& out) const;
+
+    void clear();
 
     // 从字符串重建多项式
     void parse_from_string(const string& input);
+
+    // 从 "c1,e1,c2,e2,..." 格式载入多项式, 数字前后可以有空白, 同一指数可以出现多次 (系数相加)
+    // 一次扫描、一次排序、一次合并, 与项数成线性 (加排序); 格式错误时返回 false 并置为零多项式,
+    // error_offset 非空时写入出错处在 input 中的字节偏移
+    bool load_from_string(string_view input, size_t* error_offset = nullptr);
+
+    // 由 64 位整数数组载入多项式: 第 i 项为 coefficients[i * stride] * x^exponents[i * stride]
+    // (系数与指数分成两个数组时 stride = 1, 交错存放 c0, e0, c1, e1, ... 时 stride = 2)
+    // canonical 表示指数已严格递减 (同类项已合并), 此时跳过排序与合并, 只去掉零系数项
+    // 指数或 (32 位整数类型的) 系数超出范围、或 canonical 时指数不严格递减则返回 false 并置为零多项式,
+    // error_index 非空时写入出错项的下标
+    bool load_terms(const int64_t* coefficients, const int64_t* exponents, size_t count, size_t stride, bool canonical,
+                    size_t* error_index = nullptr);
 };
 
-// 多项式管理器类: 管理多个多项式及其操作
-class PolynomialManager {
+// 默认实例: 32 位整数系数与指数, 与原有接口保持一致
+using Term = BasicTerm<int>;
+using Polynomial = BasicPolynomial<int>;
+
+// 多项式工作区: 一组命名的多项式及其操作, 各工作区的存储、锁和结果缓存互相独立
+// 多项式按名称 (标识符, 见 NameTable::is_identifier) 保存, 数量不限; 单字母接口只接受 'a' - 'e'
+// 所有接口可以从多个线程同时调用: 读取和计算在调用时的快照上进行, 互不阻塞, 也不阻塞创建和清除
+template <typename C>
+class BasicPolynomialWorkspace {
 private:
-    static mutex manager_mutex_;  // 线程安全互斥锁
-    static unordered_map<char, Polynomial> polynomials_;  // 多项式存储
-    static const int MAX_POLYNOMIALS;  // 最大多项式数量
-    static const char POLYNOMIAL_NAMES[];  // 可用多项式名称 'a', 'b', 'c', 'd', 'e'
+    // 每块保存的多项式个数; 快照之间按块共享, 修改时只复制被修改的块
+    static constexpr size_t CHUNK_SIZE = 256;
+
+    // 编号连续的一块多项式, versions[i] 为 0 表示该编号没有多项式
+    struct Chunk {
+        BasicPolynomial<C> polynomials[CHUNK_SIZE];
+        uint64_t versions[CHUNK_SIZE] = {};  // 每个多项式的版本号, 每次创建时更新
+    };
+
+    // 多项式表的不可变快照: 读操作取得快照后不再持有锁, 计算期间其他线程可以继续读取或替换多项式
+    // 写操作持有写锁; 快照、名称表或块只被当前快照引用时原地修改, 否则先复制一份 (多项式写时复制,
+    // 复制块只增加引用计数), 因此没有读者时连续创建的代价与表的大小无关
+    struct Snapshot {
+        shared_ptr<NameTable> names = make_shared<NameTable>();  // 名称 -> 编号
+        vector<shared_ptr<Chunk>> chunks;  // 编号 i 的多项式在 chunks[i / CHUNK_SIZE] 中
+        size_t count = 0;  // 多项式个数
+    };
+
+    shared_mutex mutex_;  // 读写锁, 只保护 snapshot_ 的读取和修改
+    shared_ptr<Snapshot> snapshot_;  // 当前快照
+    uint64_t next_version_;  // 持有写锁时修改
+    mutex cache_mutex_;  // 保护 cache_
+    ResultCache cache_;  // 格式化结果缓存
+    // 保留的 write_* / *_terms 计算结果个数: 两阶段调用 (先取长度再取内容) 的第二次直接复用,
+    // 不超过这么多个调用方交替进行时互不挤掉; 更多时最久未用的被挤掉, 第二阶段重新计算 (结果相同)
+    static constexpr size_t HELD_RESULTS = 4;
+
+    mutex held_mutex_;  // 保护 held_
+    vector<pair<string, shared_ptr<const BasicPolynomial<C>>>> held_;  // (键, 结果), 最近使用的在前; 键的格式同 cache_key
+
+    // 快照中名为 name 的多项式, 不存在时返回 nullptr; version 非空时写入版本号 (不存在时为 0)
+    static const BasicPolynomial<C>* lookup(const Snapshot& snapshot, string_view name, uint64_t* version = nullptr);
+
+    // 保存多项式 (持有写锁)
+    void store(string_view name, BasicPolynomial<C>&& poly);
+
+    // 取得当前快照 (只在复制指针时持有读锁)
+    shared_ptr<const Snapshot> current_snapshot();
+
+    // 缓存键: 类别 + 去掉空白的表达式 + 表达式中每个名称在快照中的版本号
+    static string cache_key(const Snapshot& snapshot, char kind, const string& expr);
+
+    bool find_cached(const string& key, string& result);
+
+    void store_cached(const string& key, const string& result);
+
+    // 取得键为 key 的结果: 已保留时直接返回, 否则调用 compute 计算后保留 (最多 HELD_RESULTS 个, LRU)
+    template <typename Compute>
+    int held_result(const string& key, Compute compute, shared_ptr<const BasicPolynomial<C>>& result);
+
+    // 在快照中的多项式上执行编译后的表达式 (临时多项式从当前分配器分配)
+    // explain 非空时追加每一步实际的计算顺序和规模
+    static int run_plan(const Snapshot& snapshot, const ExpressionPlan& plan, BasicPolynomial<C>& result,
+                        string* explain);
+
+    // execute_plan 的实现, 在给定快照上执行
+    static int execute_plan(const Snapshot& snapshot, const ExpressionPlan& plan, BasicPolynomial<C>& result,
+                            string* explain);
+
+    // parse_expression 的实现, 在给定快照上计算
+    static int parse_expression(const Snapshot& snapshot, const string& expr, BasicPolynomial<C>& result);
+
+    // 编译表达式; 失败时出错位置之前引用了不存在的多项式则返回 -5
+    static int compile_expression(const Snapshot& snapshot, const string& expr, ExpressionPlan& plan);
 
 public:
+    BasicPolynomialWorkspace();
+
+    BasicPolynomialWorkspace(const BasicPolynomialWorkspace&) = delete;
+    BasicPolynomialWorkspace& operator=(const BasicPolynomialWorkspace&) = delete;
+
+    int create_polynomial(char name, const string& input);
+
+    // 按任意名称创建多项式, 同名时替换; 返回 0 成功, -1 名称不是合法标识符, -2 解析错误
+    // 解析错误时 error_offset (非空) 为出错处在 input 中的字节偏移, 见 BasicPolynomial::load_from_string
+    int create_named_polynomial(const string& name, const string& input, size_t* error_offset = nullptr);
+
+    // 由 64 位整数数组按名称创建多项式, 不经过文本; 参数见 BasicPolynomial::load_terms
+    // 返回 0 成功, -1 名称不合法, -2 数据不合法 (error_index 非空时为出错项的下标)
+    int create_named_polynomial_from_terms(const string& name, const int64_t* coefficients, const int64_t* exponents,
+                                           size_t count, size_t stride, bool canonical, size_t* error_index = nullptr);
+
+    // 按名称获取多项式的标准格式字符串, 返回 0 成功, -1 名称不合法, -2 未找到
+    int get_named_polynomial_string(const string& name, string& result);
+
+    // 把名为 name 的多项式直接写入 out (不经过中间字符串和结果缓存); with_latex 时为 "标准格式|LaTeX 格式"
+    // 返回值同 get_named_polynomial_string
+    int write_named_polynomial(const string& name, bool with_latex, TextWriter& out);
+
+    // 把名为 name 的多项式的各项按指数降序写入 64 位整数数组 (第 i 项写到下标 i * stride), count 为项数;
+    // 项数超过 capacity 时只返回 count, 不写入. 返回 0 成功, -1 名称不合法, -2 未找到, -3 有系数超出 int64 范围
+    int get_named_polynomial_terms(const string& name, int64_t* coefficients, int64_t* exponents, size_t capacity,
+                                   size_t stride, size_t& count);
+
+    // 计算表达式并把结果直接写入 out, 不经过中间字符串; 返回值同 calculate_polynomials
+    // 结果保留到下一次计算, 按完整长度重新调用时不再计算 (与结果缓存的预算无关)
+    int write_calculation(const string& expr, bool with_latex, TextWriter& out);
+
+    // 计算导数并直接写入 out, 结果的保留同 write_calculation; 返回值同 derivative_polynomial
+    int write_derivative(char name, bool with_latex, TextWriter& out);
 
-    static int create_polynomial(char name, const string& input);
+    // 计算表达式, 结果按 get_named_polynomial_terms 的方式写入; 返回值同 calculate_polynomials, 另有 -3 同上
+    // 结果的保留同 write_calculation, 容量不足后重新调用时不再计算
+    int calculate_polynomial_terms(const string& expr, int64_t* coefficients, int64_t* exponents, size_t capacity,
+                                   size_t stride, size_t& count);
 
-    static int get_polynomial_string(char name, string& result);
+    // 当前保存的多项式个数
+    size_t polynomial_count();
 
-    static int get_polynomial_string_with_latex(char name, string& result);
+    int get_polynomial_string(char name, string& result);
 
-    static int calculate_polynomials(const string& expr, string& result);
+    int get_polynomial_string_with_latex(char name, string& result);
 
-    static int calculate_polynomials_with_latex(const string& expr, string& result);
+    int calculate_polynomials(const string& expr, string& result);
 
-    static int evaluate_polynomial(char name, int x, int& result);
+    int calculate_polynomials_with_latex(const string& expr, string& result);
 
-    static int derivative_polynomial(char name, string& result);
+    // 执行编译后的表达式, 结果格式同 calculate_polynomials / calculate_polynomials_with_latex
+    int calculate_compiled(const ExpressionPlan& plan, string& result);
 
-    static int derivative_polynomial_with_latex(char name, string& result);
+    int calculate_compiled_with_latex(const ExpressionPlan& plan, string& result);
 
-    static void clear_all();
+    int evaluate_polynomial(char name, const C& x, C& result);
+
+    int evaluate_polynomial_batch(char name, const C* xs, size_t count, C* results);
+
+    int evaluate_polynomial_multipoint(char name, const C* xs, size_t count, C* results);
+
+    int derivative_polynomial(char name, string& result);
+
+    int derivative_polynomial_with_latex(char name, string& result);
+
+    void clear_all();
+
+    // 名称为 'a' - 'e' 的多项式, 按首次创建的顺序
+    int get_polynomial_names(vector<char>& names);
+
+    // 设置结果缓存的内存预算 (字节), 超出部分按 LRU 立即淘汰; 0 表示关闭缓存
+    void set_cache_budget(size_t bytes);
+
+    void get_cache_stats(ResultCacheStats& stats);
+
+    // 在当前快照上解析并计算表达式; 临时多项式从每次求值独立的分配器中分配, 求值结束后整体回收
+    int parse_expression(const string& expr, BasicPolynomial<C>& result);
+
+    // 在当前快照上执行编译后的表达式, 引用的多项式不存在时返回 -5
+    // explain 非空时追加执行过程: 连续的 + / * 按当前多项式的规模选择的结合顺序, 每一步的项数和估计代价
+    int execute_plan(const ExpressionPlan& plan, BasicPolynomial<C>& result, string* explain = nullptr);
+
+    // 按当前绑定的多项式计算表达式, 返回执行过程的说明 (格式见 execute_plan), 用于检查规划器的选择
+    int explain_expression(const string& expr, string& result);
+};
 
-    static int get_polynomial_names(vector<char>& names);
+// 多项式管理器: 原有的静态接口, 转发给每种系数类型各一个的默认工作区, 各接口的说明见 BasicPolynomialWorkspace
+template <typename C>
+class BasicPolynomialManager {
+public:
+    static BasicPolynomialWorkspace<C>& default_workspace();
+
+    static int create_polynomial(char name, const string& input) {
+        return default_workspace().create_polynomial(name, input);
+    }
+
+    static int create_named_polynomial(const string& name, const string& input, size_t* error_offset = nullptr) {
+        return default_workspace().create_named_polynomial(name, input, error_offset);
+    }
+
+    static int create_named_polynomial_from_terms(const string& name, const int64_t* coefficients, const int64_t* exponents,
+                                                  size_t count, size_t stride, bool canonical, size_t* error_index = nullptr) {
+        return default_workspace().create_named_polynomial_from_terms(name, coefficients, exponents, count, stride, canonical,
+                                                                      error_index);
+    }
+
+    static int get_named_polynomial_string(const string& name, string& result) {
+        return default_workspace().get_named_polynomial_string(name, result);
+    }
+
+    static int write_named_polynomial(const string& name, bool with_latex, TextWriter& out) {
+        return default_workspace().write_named_polynomial(name, with_latex, out);
+    }
+
+    static int get_named_polynomial_terms(const string& name, int64_t* coefficients, int64_t* exponents, size_t capacity,
+                                          size_t stride, size_t& count) {
+        return default_workspace().get_named_polynomial_terms(name, coefficients, exponents, capacity, stride, count);
+    }
+
+    static int write_calculation(const string& expr, bool with_latex, TextWriter& out) {
+        return default_workspace().write_calculation(expr, with_latex, out);
+    }
+
+    static int write_derivative(char name, bool with_latex, TextWriter& out) {
+        return default_workspace().write_derivative(name, with_latex, out);
+    }
+
+    static int calculate_polynomial_terms(const string& expr, int64_t* coefficients, int64_t* exponents, size_t capacity,
+                                          size_t stride, size_t& count) {
+        return default_workspace().calculate_polynomial_terms(expr, coefficients, exponents, capacity, stride, count);
+    }
+
+    static size_t polynomial_count() {
+        return default_workspace().polynomial_count();
+    }
+
+    static int get_polynomial_string(char name, string& result) {
+        return default_workspace().get_polynomial_string(name, result);
+    }
+
+    static int get_polynomial_string_with_latex(char name, string& result) {
+        return default_workspace().get_polynomial_string_with_latex(name, result);
+    }
+
+    static int calculate_polynomials(const string& expr, string& result) {
+        return default_workspace().calculate_polynomials(expr, result);
+    }
+
+    static int calculate_polynomials_with_latex(const string& expr, string& result) {
+        return default_workspace().calculate_polynomials_with_latex(expr, result);
+    }
+
+    static int calculate_compiled(const ExpressionPlan& plan, string& result) {
+        return default_workspace().calculate_compiled(plan, result);
+    }
+
+    static int calculate_compiled_with_latex(const ExpressionPlan& plan, string& result) {
+        return default_workspace().calculate_compiled_with_latex(plan, result);
+    }
+
+    static int evaluate_polynomial(char name, const C& x, C& result) {
+        return default_workspace().evaluate_polynomial(name, x, result);
+    }
+
+    static int evaluate_polynomial_batch(char name, const C* xs, size_t count, C* results) {
+        return default_workspace().evaluate_polynomial_batch(name, xs, count, results);
+    }
+
+    static int evaluate_polynomial_multipoint(char name, const C* xs, size_t count, C* results) {
+        return default_workspace().evaluate_polynomial_multipoint(name, xs, count, results);
+    }
+
+    static int derivative_polynomial(char name, string& result) {
+        return default_workspace().derivative_polynomial(name, result);
+    }
+
+    static int derivative_polynomial_with_latex(char name, string& result) {
+        return default_workspace().derivative_polynomial_with_latex(name, result);
+    }
+
+    static void clear_all() {
+        default_workspace().clear_all();
+    }
+
+    static int get_polynomial_names(vector<char>& names) {
+        return default_workspace().get_polynomial_names(names);
+    }
+
+    static void set_cache_budget(size_t bytes) {
+        default_workspace().set_cache_budget(bytes);
+    }
+
+    static void get_cache_stats(ResultCacheStats& stats) {
+        default_workspace().get_cache_stats(stats);
+    }
+
+    static int parse_expression(const string& expr, BasicPolynomial<C>& result) {
+        return default_workspace().parse_expression(expr, result);
+    }
+
+    static int execute_plan(const ExpressionPlan& plan, BasicPolynomial<C>& result, string* explain = nullptr) {
+        return default_workspace().execute_plan(plan, result, explain);
+    }
+
+    static int explain_expression(const string& expr, string& result) {
+        return default_workspace().explain_expression(expr, result);
+    }
+};
+
+using PolynomialManager = BasicPolynomialManager<int>;
+
+// 系数类型编号 (C 接口 set_polynomial_coefficient_type 的参数)
+enum CoefficientKind {
+    COEFFICIENT_INT32 = 0,    // int, 溢出按补码回绕 (默认)
+    COEFFICIENT_INT64 = 1,    // int64_t, 溢出按补码回绕
+    COEFFICIENT_INT128 = 2,   // __int128, 溢出按补码回绕, 仅在编译器支持时可用
+    COEFFICIENT_MODULAR = 3,  // 模 998244353 的剩余类
+    COEFFICIENT_BIGINT = 4,   // 任意精度整数
+};
+
+// PolynomialEngine: 按系数类型擦除后的工作区接口, 供 C 接口按当前选择的类型或工作区句柄调用
+class PolynomialEngine {
+public:
+    virtual ~PolynomialEngine() {}
+
+    virtual int create_polynomial(char name, const string& input) = 0;
+
+    virtual int create_named_polynomial(const string& name, const string& input, size_t* error_offset = nullptr) = 0;
+
+    virtual int create_named_polynomial_from_terms(const string& name, const int64_t* coefficients, const int64_t* exponents,
+                                                   size_t count, size_t stride, bool canonical,
+                                                   size_t* error_index = nullptr) = 0;
+
+    virtual int get_named_polynomial_string(const string& name, string& result) = 0;
+
+    virtual int write_named_polynomial(const string& name, bool with_latex, TextWriter& out) = 0;
+
+    virtual int get_named_polynomial_terms(const string& name, int64_t* coefficients, int64_t* exponents, size_t capacity,
+                                           size_t stride, size_t& count) = 0;
+
+    virtual int write_calculation(const string& expr, bool with_latex, TextWriter& out) = 0;
+
+    virtual int write_derivative(char name, bool with_latex, TextWriter& out) = 0;
+
+    virtual int calculate_polynomial_terms(const string& expr, int64_t* coefficients, int64_t* exponents, size_t capacity,
+                                           size_t stride, size_t& count) = 0;
+
+    virtual size_t polynomial_count() = 0;
+
+    virtual int get_polynomial_string(char name, string& result) = 0;
+
+    virtual int get_polynomial_string_with_latex(char name, string& result) = 0;
+
+    virtual int calculate_polynomials(const string& expr, string& result) = 0;
+
+    virtual int calculate_polynomials_with_latex(const string& expr, string& result) = 0;
+
+    virtual int calculate_compiled(const ExpressionPlan& plan, string& result) = 0;
+
+    virtual int calculate_compiled_with_latex(const ExpressionPlan& plan, string& result) = 0;
+
+    virtual int explain_expression(const string& expr, string& result) = 0;
+
+    // 求值, 结果截断为 int (模素数类型返回剩余)
+    virtual int evaluate_polynomial(char name, int x, int& result) = 0;
+
+    // 求值, 结果为十进制字符串, 不截断
+    virtual int evaluate_polynomial(char name, int x, string& result) = 0;
+
+    // 批量求值, 结果截断为 int
+    virtual int evaluate_polynomial_batch(char name, const int* xs, int count, int* results) = 0;
+
+    virtual int derivative_polynomial(char name, string& result) = 0;
+
+    virtual int derivative_polynomial_with_latex(char name, string& result) = 0;
+
+    virtual void clear_all() = 0;
+
+    virtual int get_polynomial_names(vector<char>& names) = 0;
+
+    virtual void set_cache_budget(size_t bytes) = 0;
+
+    virtual void get_cache_stats(ResultCacheStats& stats) = 0;
+};
+
+// 返回指定系数类型的引擎 (作用于该类型的默认工作区), 类型不可用时返回 nullptr
+PolynomialEngine* polynomial_engine(int kind);
+
+// 创建一个拥有独立工作区的引擎, 用 delete 释放; 类型不可用时返回 nullptr
+PolynomialEngine* create_polynomial_engine(int kind);
+
+// 选择后续 C 接口使用的系数类型, 成功返回 0, 类型不可用返回 -1
+int set_active_coefficient_kind(int kind);
+
+int active_coefficient_kind();
+
+// 当前线程使用的引擎: ScopedPolynomialEngine 作用域内为其指定的引擎, 否则为当前选择的系数类型对应的引擎
+PolynomialEngine& active_polynomial_engine();
+
+// 在作用域内把当前线程的 active_polynomial_engine() 换成 engine, 离开时恢复; C 接口的工作区版本用它复用原有接口
+class ScopedPolynomialEngine {
+public:
+    explicit ScopedPolynomialEngine(PolynomialEngine* engine);
+    ~ScopedPolynomialEngine();
+
+    ScopedPolynomialEngine(const ScopedPolynomialEngine&) = delete;
+    ScopedPolynomialEngine& operator=(const ScopedPolynomialEngine&) = delete;
+
+private:
+    PolynomialEngine* previous_;
+};
 
-    static int parse_expression(const string& expr, Polynomial& result);
-};
\ No newline at end of file
+// 显式实例化 (定义见 polynomial.cpp)
+extern template class BasicTerm<int>;
+extern template class BasicPolynomial<int>;
+extern template class BasicPolynomialWorkspace<int>;
+extern template class BasicPolynomialManager<int>;
+extern template class BasicTerm<int64_t>;
+extern template class BasicPolynomial<int64_t>;
+extern template class BasicPolynomialWorkspace<int64_t>;
+extern template class BasicPolynomialManager<int64_t>;
+#if POLYNOMIAL_HAS_INT128
+extern template class BasicTerm<__int128>;
+extern template class BasicPolynomial<__int128>;
+extern template class BasicPolynomialWorkspace<__int128>;
+extern template class BasicPolynomialManager<__int128>;
+#endif
+extern template class BasicTerm<Zp>;
+extern template class BasicPolynomial<Zp>;
+extern template class BasicPolynomialWorkspace<Zp>;
+extern template class BasicPolynomialManager<Zp>;
+extern template class BasicTerm<BigInt>;
+extern template class BasicPolynomial<BigInt>;
+extern template class BasicPolynomialWorkspace<BigInt>;
+extern template class BasicPolynomialManager<BigInt>;
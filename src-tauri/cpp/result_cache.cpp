@@ -0,0 +1,74 @@
+#include "result_cache.hpp"
+
+using namespace std;
+
+ResultCache::ResultCache(size_t budget) : budget_(budget), bytes_(0), hits_(0), misses_(0) {
+}
+
+bool ResultCache::find(const string& key, string& result) {
+    auto it = index_.find(key);
+    if (it == index_.end()) {
+        ++misses_;
+        return false;
+    }
+
+    // 移到链表头部
+    lru_.splice(lru_.begin(), lru_, it->second);
+    result = it->second->value;
+    ++hits_;
+    return true;
+}
+
+void ResultCache::insert(const string& key, const string& value) {
+    bool fits = key.size() + value.size() + ENTRY_OVERHEAD <= budget_;
+    auto it = index_.find(key);
+    if (it != index_.end()) {
+        auto node = it->second;
+        bytes_ -= entry_size(*node);
+        if (!fits) {
+            // 先删索引: 索引的键指向链表节点中的字符串
+            index_.erase(it);
+            lru_.erase(node);
+            return;
+        }
+        // 原地更新并移到链表头部, 节点中的 key 不变, 索引仍然有效
+        node->value = value;
+        lru_.splice(lru_.begin(), lru_, node);
+        bytes_ += entry_size(*node);
+        evict();
+        return;
+    }
+
+    if (!fits) {
+        return;
+    }
+
+    lru_.push_front({key, value});
+    index_.emplace(string_view(lru_.front().key), lru_.begin());
+    bytes_ += entry_size(lru_.front());
+    evict();
+}
+
+void ResultCache::clear() {
+    index_.clear();
+    lru_.clear();
+    bytes_ = 0;
+}
+
+void ResultCache::set_budget(size_t bytes) {
+    budget_ = bytes;
+    evict();
+}
+
+ResultCacheStats ResultCache::stats() const {
+    return {hits_, misses_, index_.size(), bytes_, budget_};
+}
+
+void ResultCache::evict() {
+    while (bytes_ > budget_ && !lru_.empty()) {
+        const Entry& oldest = lru_.back();
+        bytes_ -= entry_size(oldest);
+        index_.erase(string_view(oldest.key));
+        lru_.pop_back();
+    }
+}
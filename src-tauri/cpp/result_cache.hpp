@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// 缓存的统计信息
+struct ResultCacheStats {
+    uint64_t hits;     // 命中次数
+    uint64_t misses;   // 未命中次数
+    size_t entries;    // 当前条目数
+    size_t bytes;      // 当前占用 (估计值)
+    size_t budget;     // 内存预算
+};
+
+// 格式化结果的 LRU 缓存, 键和值都是字符串, 与系数类型无关
+// 键中包含所引用多项式的版本号, 多项式修改后旧键不会再命中, 随 LRU 淘汰
+// 占用超过预算时淘汰最久未使用的条目; 本身不加锁, 由调用方加锁
+class ResultCache {
+public:
+    // 默认预算 16 MiB
+    static constexpr size_t DEFAULT_BUDGET = 16 * 1024 * 1024;
+
+    // 每个条目除键和值以外的估计开销 (链表节点, 哈希表节点, 字符串头)
+    static constexpr size_t ENTRY_OVERHEAD = 128;
+
+    explicit ResultCache(size_t budget = DEFAULT_BUDGET);
+
+    ResultCache(const ResultCache&) = delete;
+    ResultCache& operator=(const ResultCache&) = delete;
+
+    // 命中时把结果复制到 result 并返回 true, 同时计入命中或未命中次数
+    bool find(const std::string& key, std::string& result);
+
+    // 登记结果, 已存在时覆盖; 单个条目超过预算时不缓存
+    void insert(const std::string& key, const std::string& value);
+
+    // 清空所有条目, 统计次数保留
+    void clear();
+
+    // 设置预算 (字节), 立即淘汰超出的部分; 0 表示关闭缓存
+    void set_budget(size_t bytes);
+
+    ResultCacheStats stats() const;
+
+private:
+    struct Entry {
+        std::string key;
+        std::string value;
+    };
+
+    std::list<Entry> lru_;  // 最近使用的在前
+    std::unordered_map<std::string_view, std::list<Entry>::iterator> index_;  // 键指向链表节点中的 key
+    size_t budget_;
+    size_t bytes_;
+    uint64_t hits_;
+    uint64_t misses_;
+
+    static size_t entry_size(const Entry& entry) {
+        return entry.key.size() + entry.value.size() + ENTRY_OVERHEAD;
+    }
+
+    // 淘汰最久未使用的条目, 直到占用不超过预算
+    void evict();
+};
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <memory>
+#include <new>
 #include <stdexcept>
 #include <string>
 #include <cstring>
@@ -8,48 +9,88 @@
 #include <sstream>
 
 
-template <typename T>
+// 栈: 存储为未初始化的原始内存, push / emplace 时才构造元素, pop / clear 时析构,
+// 因此开销只与实际深度有关; 容量不足时翻倍
+// INLINE_CAPACITY: 内联存储的元素个数, 深度不超过它时不申请堆内存
+template <typename T, size_t INLINE_CAPACITY = 8>
 class Stack {
 private:
-    T *data_;   //data_ 私有成员命名规范
-    int cnt_;
+    T *data_;   //data_ 私有成员命名规范, 指向 inline_data_ 或堆上的内存
+    int cnt_;   //data_[0..cnt_) 为已构造的元素, 其余为未初始化内存
     size_t capacity_;    //size_t非负无符号数
+    alignas(T) unsigned char inline_data_[INLINE_CAPACITY * sizeof(T)];  // 内联存储 (未初始化)
+
+    T* inline_begin() noexcept {
+        return reinterpret_cast<T*>(inline_data_);
+    }
+
+    bool uses_inline() const noexcept {
+        return data_ == reinterpret_cast<const T*>(inline_data_);
+    }
+
+    // 分配 / 释放未初始化的内存
+    static T* allocate(size_t capacity) {
+        return static_cast<T*>(::operator new(capacity * sizeof(T)));
+    }
+
+    void deallocate() noexcept {
+        if (!uses_inline()) {
+            ::operator delete(static_cast<void*>(data_));
+        }
+    }
+
+    // 把已有元素移动到 new_data 并析构原位置的元素, 然后切换到 new_data
+    void relocate(T* new_data, size_t new_capacity) noexcept {
+        for (int i = 0; i < cnt_; ++i) {
+            new (new_data + i) T(std::move(data_[i]));
+            data_[i].~T();
+        }
+        deallocate();
+        data_ = new_data;
+        capacity_ = new_capacity;
+    }
 
 public:
-    explicit Stack(size_t capacity = 10000)  //explicit 防止隐式转换
-        : capacity_(capacity), cnt_(0){
-        data_ = new T[capacity_];
+    explicit Stack(size_t capacity = INLINE_CAPACITY)  //explicit 防止隐式转换
+        : cnt_(0), capacity_(capacity > INLINE_CAPACITY ? capacity : INLINE_CAPACITY){
+        // 只预留内存, 不构造元素
+        data_ = capacity_ > INLINE_CAPACITY ? allocate(capacity_) : inline_begin();
     }
 
+    Stack(const Stack&) = delete;
+    Stack& operator=(const Stack&) = delete;
 
     ~Stack(){
-        delete[] data_;
+        clear();
+        deallocate();
     }
 
-    void push(const T& item) {
-        if (cnt_ == capacity_) {
-            capacity_ <<= 1;
-            T *tmp = new T[capacity_];
-            for (int i = 0; i < cnt_; ++i) {
-                tmp[i] = data_[i];
+    // 在栈顶直接构造元素
+    template <typename... Args>
+    T& emplace(Args&&... args) {
+        if (static_cast<size_t>(cnt_) == capacity_) {
+            // 参数可能引用栈内元素, 先在新内存中构造新元素, 再移动已有元素
+            size_t new_capacity = capacity_ << 1;
+            T* tmp = allocate(new_capacity);
+            try {
+                new (tmp + cnt_) T(std::forward<Args>(args)...);
+            } catch (...) {
+                ::operator delete(static_cast<void*>(tmp));
+                throw;
             }
-            delete[] data_;
-            data_ = tmp;
+            relocate(tmp, new_capacity);
+        } else {
+            new (data_ + cnt_) T(std::forward<Args>(args)...);
         }
-        data_[cnt_++] = item;
+        return data_[cnt_++];
+    }
+
+    void push(const T& item) {
+        emplace(item);
     }
 
     void push(T&& item) {
-        if (cnt_ == capacity_) {
-            capacity_ <<= 1;
-            T *tmp = new T[capacity_];
-            for (int i = 0; i < cnt_; ++i) {
-                tmp[i] = std::move(data_[i]);
-            }
-            delete[] data_;
-            data_ = tmp;
-        }
-        data_[cnt_++] = std::move(item);
+        emplace(std::move(item));
     }
 
     T pop() {
@@ -57,7 +98,7 @@ public:
             throw std::underflow_error("Stack is empty");
         }
         T item = std::move(data_[cnt_ - 1]);
-        cnt_--;
+        data_[--cnt_].~T();
         return item;
     }
 
@@ -88,7 +129,9 @@ public:
     }
 
     void clear() noexcept {
-        cnt_ = 0;
+        while (cnt_ > 0) {
+            data_[--cnt_].~T();
+        }
     }
 
     std::string to_string() const {
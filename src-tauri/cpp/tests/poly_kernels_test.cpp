@@ -0,0 +1,375 @@
+// 乘法内核的回归测试: 各算法层 (朴素 / Karatsuba / Toom-3 / NTT) 在阈值附近的长度上与朴素乘法逐位对比,
+// 并经 BasicPolynomial 的乘法与平方覆盖全部五种系数类型; 子乘积树多点求值与逐点 Horner 对比
+// 由 CMakeLists.txt 的 poly_kernels_test 目标构建, ctest 运行
+
+#include "polynomial.hpp"
+#include "poly_multiply.hpp"
+#include "multipoint.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+int g_failures = 0;
+
+#define CHECK(cond, ...)                                                       \
+    do {                                                                       \
+        if (!(cond)) {                                                         \
+            ++g_failures;                                                      \
+            printf("FAIL %s:%d: %s  ", __FILE__, __LINE__, #cond);             \
+            printf(__VA_ARGS__);                                               \
+            printf("\n");                                                      \
+        }                                                                      \
+    } while (0)
+
+mt19937_64 g_rng(20240601);
+
+// 参考实现使用的环运算: 定宽整数按同宽度的无符号数回绕, 其他类型直接使用运算符
+template <typename C>
+struct Ring {
+    static C add(const C& a, const C& b) { return a + b; }
+    static C mul(const C& a, const C& b) { return a * b; }
+};
+
+template <>
+struct Ring<int> {
+    static int add(int a, int b) { return static_cast<int>(static_cast<uint32_t>(a) + static_cast<uint32_t>(b)); }
+    static int mul(int a, int b) { return static_cast<int>(static_cast<uint32_t>(a) * static_cast<uint32_t>(b)); }
+};
+
+template <>
+struct Ring<int64_t> {
+    static int64_t add(int64_t a, int64_t b) {
+        return static_cast<int64_t>(static_cast<uint64_t>(a) + static_cast<uint64_t>(b));
+    }
+    static int64_t mul(int64_t a, int64_t b) {
+        return static_cast<int64_t>(static_cast<uint64_t>(a) * static_cast<uint64_t>(b));
+    }
+};
+
+#if POLYNOMIAL_HAS_INT128
+template <>
+struct Ring<__int128> {
+    static __int128 add(__int128 a, __int128 b) {
+        return static_cast<__int128>(static_cast<unsigned __int128>(a) + static_cast<unsigned __int128>(b));
+    }
+    static __int128 mul(__int128 a, __int128 b) {
+        return static_cast<__int128>(static_cast<unsigned __int128>(a) * static_cast<unsigned __int128>(b));
+    }
+};
+#endif
+
+// 随机系数: 定宽整数取满宽度 (检验回绕), __int128 取 40 位 (累加不溢出), 其他类型由 64 位整数转换
+template <typename C>
+C random_coefficient() {
+    int64_t value = static_cast<int64_t>(g_rng());
+#if POLYNOMIAL_HAS_INT128
+    if constexpr (is_same<C, __int128>::value) {
+        value >>= 24;
+    }
+#endif
+    return coefficient_traits<C>::from_int64(value);
+}
+
+template <typename C>
+vector<C> random_coefficients(size_t n) {
+    vector<C> coeffs(n);
+    for (C& c : coeffs) {
+        c = random_coefficient<C>();
+    }
+    if (coeffs.back() == C()) {
+        coeffs.back() = coefficient_traits<C>::from_int64(1);  // 保持最高位非零, 长度即次数加一
+    }
+    return coeffs;
+}
+
+vector<uint64_t> random_words(size_t n) {
+    vector<uint64_t> words(n);
+    for (uint64_t& w : words) {
+        w = g_rng();
+    }
+    return words;
+}
+
+// 朴素卷积 (参考实现)
+template <typename C>
+vector<C> reference_product(const vector<C>& a, const vector<C>& b) {
+    vector<C> out(a.size() + b.size() - 1, C());
+    for (size_t i = 0; i < a.size(); ++i) {
+        for (size_t j = 0; j < b.size(); ++j) {
+            out[i + j] = Ring<C>::add(out[i + j], Ring<C>::mul(a[i], b[j]));
+        }
+    }
+    return out;
+}
+
+template <typename C>
+BasicPolynomial<C> make_polynomial(const vector<C>& coeffs) {
+    string input;
+    for (size_t i = 0; i < coeffs.size(); ++i) {
+        if (coeffs[i] == C()) {
+            continue;
+        }
+        if (!input.empty()) {
+            input += ',';
+        }
+        input += coefficient_traits<C>::to_string(coeffs[i]) + "," + to_string(i);
+    }
+    BasicPolynomial<C> poly;
+    if (!poly.load_from_string(input)) {
+        CHECK(false, "load_from_string");
+    }
+    return poly;
+}
+
+// 按指数展开为系数数组 (长度 size), 与参考结果逐位比较
+template <typename C>
+bool same_coefficients(const BasicPolynomial<C>& poly, const vector<C>& expected) {
+    vector<C> actual(expected.size(), C());
+    bool in_range = true;
+    poly.for_each_term([&](const C& coeff, int exp) {
+        if (exp < 0 || static_cast<size_t>(exp) >= actual.size()) {
+            in_range = false;
+        } else {
+            actual[exp] = coeff;
+        }
+    });
+    return in_range && actual == expected;
+}
+
+// 阈值两侧的长度
+vector<size_t> threshold_sizes() {
+    const size_t k = poly_kernels::KARATSUBA_THRESHOLD;
+    const size_t t = poly_kernels::TOOM3_THRESHOLD;
+    return {1, 2, k - 1, k, k + 1, 2 * k + 1, t - 1, t, t + 1, 2 * t + 5};
+}
+
+// 求值点: 任意精度系数取小整数, 避免值的位数随次数膨胀
+template <typename C>
+C random_point() {
+    if constexpr (is_same<C, BigInt>::value) {
+        return coefficient_traits<C>::from_int64(static_cast<int64_t>(g_rng() % 101) - 50);
+    }
+    return random_coefficient<C>();
+}
+
+template <typename C>
+vector<C> random_points(size_t n) {
+    vector<C> points(n);
+    for (C& x : points) {
+        x = random_point<C>();
+    }
+    return points;
+}
+
+// 逐点 Horner (参考实现), 系数按指数升序
+template <typename C>
+C reference_evaluate(const vector<C>& coeffs, const C& x) {
+    C r = C();
+    for (size_t i = coeffs.size(); i-- > 0;) {
+        r = Ring<C>::add(Ring<C>::mul(r, x), coeffs[i]);
+    }
+    return r;
+}
+
+// 64 位内核: multiply_balanced / multiply_coefficients 与朴素乘法逐位一致, 开启 Toom-3 时低 32 位一致
+void test_word_kernels() {
+    for (size_t n : threshold_sizes()) {
+        vector<uint64_t> a = random_words(n), b = random_words(n);
+        vector<uint64_t> expected(2 * n - 1), square_expected(2 * n - 1), out(2 * n - 1);
+        poly_kernels::multiply_schoolbook(a.data(), n, b.data(), n, expected.data());
+        poly_kernels::multiply_schoolbook(a.data(), n, a.data(), n, square_expected.data());
+
+        poly_kernels::multiply_balanced(a.data(), b.data(), n, out.data(), false);
+        CHECK(out == expected, "balanced n=%zu", n);
+        poly_kernels::multiply_balanced(a.data(), a.data(), n, out.data(), false);
+        CHECK(out == square_expected, "balanced square n=%zu", n);
+
+        poly_kernels::multiply_balanced(a.data(), b.data(), n, out.data(), true);
+        bool low_equal = true;
+        for (size_t i = 0; i < out.size(); ++i) {
+            low_equal = low_equal && static_cast<uint32_t>(out[i]) == static_cast<uint32_t>(expected[i]);
+        }
+        CHECK(low_equal, "toom low 32 bits n=%zu", n);
+    }
+
+    // 长度不等: 较长一侧分块
+    const size_t t = poly_kernels::TOOM3_THRESHOLD;
+    const size_t k = poly_kernels::KARATSUBA_THRESHOLD;
+    size_t la = 3 * t + 7, lb = k + 3;
+    vector<uint64_t> a = random_words(la), b = random_words(lb);
+    vector<uint64_t> expected(la + lb - 1), out(la + lb - 1);
+    poly_kernels::multiply_schoolbook(a.data(), la, b.data(), lb, expected.data());
+    poly_kernels::multiply_coefficients(a.data(), la, b.data(), lb, out.data(), false);
+    CHECK(out == expected, "unbalanced %zu x %zu", la, lb);
+    poly_kernels::multiply_coefficients(b.data(), lb, a.data(), la, out.data(), false);
+    CHECK(out == expected, "unbalanced %zu x %zu", lb, la);
+}
+
+// 有符号 bits 位的随机数 (按补码放进 uint64_t)
+vector<uint64_t> random_signed_words(size_t n, int bits) {
+    vector<uint64_t> words(n);
+    for (uint64_t& w : words) {
+        w = static_cast<uint64_t>(static_cast<int64_t>(g_rng()) >> (64 - bits));
+    }
+    return words;
+}
+
+// NTT + CRT: 所选素数足够时结果在 2^64 下与朴素乘法一致; 素数不够时返回 false,
+// multiply_coefficients 此时改用其他算法, 结果同样一致
+void test_ntt_kernel() {
+    const size_t threshold = poly_kernels::NTT_THRESHOLD;
+    struct Case {
+        size_t la, lb;
+        int bits;
+    };
+    const Case cases[] = {{1, 1, 20}, {17, 5, 20}, {1000, 999, 30}, {threshold, threshold, 30},
+                          {threshold + 1, threshold, 20}, {threshold, 3 * threshold / 2 + 3, 30}};
+    for (const Case& c : cases) {
+        vector<uint64_t> a = random_signed_words(c.la, c.bits), b = random_signed_words(c.lb, c.bits);
+        vector<uint64_t> expected(c.la + c.lb - 1), out(c.la + c.lb - 1);
+        poly_kernels::multiply_schoolbook(a.data(), c.la, b.data(), c.lb, expected.data());
+        bool done = poly_kernels::multiply_ntt(a.data(), c.la, b.data(), c.lb, out.data());
+        CHECK(done && out == expected, "ntt %zu x %zu, %d bits", c.la, c.lb, c.bits);
+    }
+
+    vector<uint64_t> a = random_signed_words(threshold, 30);
+    vector<uint64_t> expected(2 * threshold - 1), out(2 * threshold - 1);
+    poly_kernels::multiply_schoolbook(a.data(), threshold, a.data(), threshold, expected.data());
+    bool done = poly_kernels::multiply_ntt(a.data(), threshold, a.data(), threshold, out.data());
+    CHECK(done && out == expected, "ntt square %zu", threshold);
+
+    // 满 64 位的系数需要的素数超过上限: 允许返回 false, 返回 true 时必须正确
+    a = random_words(threshold);
+    vector<uint64_t> b = random_words(threshold);
+    poly_kernels::multiply_schoolbook(a.data(), threshold, b.data(), threshold, expected.data());
+    if (poly_kernels::multiply_ntt(a.data(), threshold, b.data(), threshold, out.data())) {
+        CHECK(out == expected, "ntt full width %zu", threshold);
+    }
+
+    // 阈值两侧经 multiply_coefficients 选择
+    for (size_t n : {threshold - 1, threshold}) {
+        for (int bits : {30, 64}) {
+            vector<uint64_t> x = random_signed_words(n, bits), y = random_signed_words(n + 5, bits);
+            vector<uint64_t> want(2 * n + 4), got(2 * n + 4);
+            poly_kernels::multiply_schoolbook(x.data(), n, y.data(), n + 5, want.data());
+            poly_kernels::multiply_coefficients(x.data(), n, y.data(), n + 5, got.data(), false);
+            CHECK(got == want, "coefficients %zu x %zu, %d bits", n, n + 5, bits);
+        }
+    }
+}
+
+// 通用 Karatsuba 与朴素乘法一致
+template <typename C>
+void test_generic_kernel(const char* kind) {
+    const size_t k = poly_kernels::KARATSUBA_THRESHOLD;
+    for (size_t n : {k - 1, k, k + 1, 2 * k + 3, 4 * k + 1}) {
+        vector<C> a = random_coefficients<C>(n), b = random_coefficients<C>(n);
+        vector<C> out(2 * n - 1);
+        poly_kernels::multiply_generic(a.data(), n, b.data(), n, out.data());
+        CHECK(out == reference_product(a, b), "%s generic n=%zu", kind, n);
+        poly_kernels::multiply_generic(a.data(), n, a.data(), n, out.data());
+        CHECK(out == reference_product(a, a), "%s generic square n=%zu", kind, n);
+    }
+
+    size_t la = 5 * k + 2, lb = k + 5;
+    vector<C> a = random_coefficients<C>(la), b = random_coefficients<C>(lb);
+    vector<C> out(la + lb - 1);
+    poly_kernels::multiply_generic(a.data(), la, b.data(), lb, out.data());
+    CHECK(out == reference_product(a, b), "%s generic %zu x %zu", kind, la, lb);
+}
+
+// BasicPolynomial 的乘法与平方 (稠密操作数走上面的内核)
+template <typename C>
+void test_polynomial_product(const char* kind, size_t la, size_t lb) {
+    vector<C> a = random_coefficients<C>(la), b = random_coefficients<C>(lb);
+    BasicPolynomial<C> pa = make_polynomial(a), pb = make_polynomial(b);
+    CHECK(same_coefficients(pa * pb, reference_product(a, b)), "%s product %zu x %zu", kind, la, lb);
+    CHECK(same_coefficients(pa.square(), reference_product(a, a)), "%s square %zu", kind, la);
+    CHECK(same_coefficients(pa * pa, reference_product(a, a)), "%s self product %zu", kind, la);
+}
+
+template <typename C>
+void test_polynomial_products(const char* kind) {
+    for (size_t n : threshold_sizes()) {
+        test_polynomial_product<C>(kind, n, n);
+    }
+    test_polynomial_product<C>(kind, 3 * poly_kernels::TOOM3_THRESHOLD + 7, poly_kernels::KARATSUBA_THRESHOLD + 3);
+    if constexpr (coefficient_traits<C>::machine_word) {
+        test_polynomial_product<C>(kind, poly_kernels::NTT_THRESHOLD, poly_kernels::NTT_THRESHOLD + 1);  // NTT 层
+    }
+}
+
+// 子乘积树: 点数取叶子块与快速取余阈值两侧, 次数取低于点数 (直接降到叶子)
+// 和高于点数 (根节点取余的商超过 FAST_REMAINDER_THRESHOLD) 两种
+template <typename C>
+void test_multipoint(const char* kind) {
+    const size_t leaf = poly_multipoint::LEAF_POINTS;
+    const size_t fast = poly_multipoint::FAST_REMAINDER_THRESHOLD;
+    for (size_t count : {size_t(1), size_t(2), leaf - 1, leaf, leaf + 1, 2 * leaf + 1, fast - 1, fast, fast + 1,
+                         4 * fast + 3}) {
+        vector<C> points = random_points<C>(count);
+        for (size_t degree : {count / 2, count + fast + 5}) {
+            vector<C> coeffs = random_coefficients<C>(degree + 1);
+            vector<C> values = poly_multipoint::evaluate_multipoint(coeffs, points);
+            bool same = values.size() == count;
+            for (size_t i = 0; same && i < count; ++i) {
+                same = values[i] == reference_evaluate(coeffs, points[i]);
+            }
+            CHECK(same, "%s multipoint %zu points, degree %zu", kind, count, degree);
+        }
+    }
+}
+
+// evaluate_batch 在 10000 个点上 (机器字与模数系数走子乘积树) 与逐点 Horner、evaluate 一致
+template <typename C>
+void test_batch_evaluation(const char* kind) {
+    const size_t count = 10000;
+    const size_t degree = is_same<C, BigInt>::value ? 60 : count / 2 - 1;
+    vector<C> coeffs = random_coefficients<C>(degree + 1);
+    vector<C> points = random_points<C>(count);
+    BasicPolynomial<C> poly = make_polynomial(coeffs);
+
+    vector<C> values(count);
+    poly.evaluate_batch(points.data(), count, values.data());
+    bool same = true;
+    for (size_t i = 0; same && i < count; ++i) {
+        same = values[i] == reference_evaluate(coeffs, points[i]) && values[i] == poly.evaluate(points[i]);
+    }
+    CHECK(same, "%s evaluate_batch %zu points, degree %zu", kind, count, degree);
+}
+
+template <typename C>
+void test_coefficient_kind(const char* kind) {
+    test_generic_kernel<C>(kind);
+    test_polynomial_products<C>(kind);
+    test_multipoint<C>(kind);
+    test_batch_evaluation<C>(kind);
+}
+
+} // namespace
+
+int main() {
+    test_word_kernels();
+    test_ntt_kernel();
+
+    test_coefficient_kind<int>("int");
+    test_coefficient_kind<int64_t>("int64");
+#if POLYNOMIAL_HAS_INT128
+    test_coefficient_kind<__int128>("int128");
+#endif
+    test_coefficient_kind<Zp>("modular");
+    test_coefficient_kind<BigInt>("bigint");
+
+    if (g_failures != 0) {
+        printf("%d check(s) failed\n", g_failures);
+        return 1;
+    }
+    printf("all checks passed\n");
+    return 0;
+}
@@ -11,22 +11,56 @@ extern "C" {
 // 声明外部 C++ 多项式函数
 extern "C" {
     fn create_polynomial(name: std::os::raw::c_char, input: *const std::os::raw::c_char) -> i32;
-    fn get_polynomial_to_string(name: std::os::raw::c_char, output: *mut std::os::raw::c_char, buffer_size: i32) -> i32;
-    fn calculate_polynomials(expression: *const std::os::raw::c_char, output: *mut std::os::raw::c_char, buffer_size: i32) -> i32;
     fn evaluate_polynomial(name: std::os::raw::c_char, x: i32, result: *mut i32) -> i32;
-    fn derivative_polynomial(name: std::os::raw::c_char, output: *mut std::os::raw::c_char, buffer_size: i32) -> i32;
     fn clear_all_polynomials() -> i32;
     fn get_polynomial_names(names: *mut std::os::raw::c_char, max_count: i32) -> i32;
     fn polynomial_exists(name: std::os::raw::c_char) -> i32;
     fn get_polynomial_term_count(name: std::os::raw::c_char, count: *mut i32) -> i32;
     fn get_polynomial_error_description(error_code: i32) -> *const std::os::raw::c_char;
-    // New LaTeX functions
-    fn get_polynomial_string_with_latex(name: std::os::raw::c_char, output: *mut std::os::raw::c_char, buffer_size: i32) -> i32;
-    fn calculate_polynomials_with_latex(expression: *const std::os::raw::c_char, output: *mut std::os::raw::c_char, buffer_size: i32) -> i32;
-    fn derivative_polynomial_with_latex(name: std::os::raw::c_char, output: *mut std::os::raw::c_char, buffer_size: i32) -> i32;
+    // 两阶段输出: 返回完整长度, 缓冲区不够时按长度重新分配后再调用 (见 calc_polynomial.cpp 中 write_* 接口的说明)
+    fn write_polynomial_string(name: *const std::os::raw::c_char, format: i32, output: *mut std::os::raw::c_char, buffer_size: i64, length: *mut i64) -> i32;
+    fn write_calculation_result(expression: *const std::os::raw::c_char, format: i32, output: *mut std::os::raw::c_char, buffer_size: i64, length: *mut i64) -> i32;
+    fn write_derivative_result(name: std::os::raw::c_char, format: i32, output: *mut std::os::raw::c_char, buffer_size: i64, length: *mut i64) -> i32;
+}
+
+use std::ffi::CString;
+
+// write_* 接口的 format
+const OUTPUT_STANDARD: i32 = 0;   // 标准格式
+const OUTPUT_WITH_LATEX: i32 = 1; // "标准格式|LaTeX 格式"
+
+// 读取 write_* 接口的文本结果: 先用默认大小的缓冲区, 不够时按返回的完整长度分配后再调用一次
+// (两次调用之间结果可能被修改, 因此循环直到缓冲区足够); 失败时返回错误码
+fn read_text_output<F>(mut write: F) -> Result<String, i32>
+where
+    F: FnMut(*mut std::os::raw::c_char, i64, *mut i64) -> i32,
+{
+    let mut buffer = vec![0u8; 1024];
+    loop {
+        let mut length: i64 = 0;
+        let result = write(buffer.as_mut_ptr() as *mut std::os::raw::c_char, buffer.len() as i64, &mut length);
+        if result != 0 {
+            return Err(result);
+        }
+        let length = length as usize;
+        if length < buffer.len() {
+            buffer.truncate(length);
+            return Ok(String::from_utf8_lossy(&buffer).into_owned());
+        }
+        buffer.resize(length + 1, 0);
+    }
 }
 
-use std::ffi::{CStr, CString};
+// 把 "标准格式|LaTeX 格式" 分成两部分
+fn split_latex_output(combined: String) -> (String, String) {
+    if let Some(pipe_pos) = combined.find('|') {
+        let standard = combined[..pipe_pos].to_string();
+        let latex = combined[pipe_pos + 1..].to_string();
+        (standard, latex)
+    } else {
+        (combined.clone(), combined)
+    }
+}
 
 // 安全的 C++ 栈函数包装器
 fn init_stack_safe(capacity: i32) -> Result<String, String> {
@@ -140,9 +174,9 @@ fn create_polynomial_safe(name: char, input: &str) -> Result<String, String> {
 
         match result {
             0 => Ok(format!("多项式 '{}' 创建成功", name)),
-            -1 => Err("无效的多项式名称 (必须是 a-e)".to_string()),
-            -2 => Err("无效的输入格式".to_string()),
-            -3 => Err("多项式数量超过限制 (最多5个)".to_string()),
+            -1 => Err("无效的多项式名称".to_string()),
+            -3 => Err("无效的输入".to_string()),
+            -10 => Err("无效的输入格式".to_string()),
             _ => Err("未知错误".to_string())
         }
     }
@@ -150,55 +184,40 @@ fn create_polynomial_safe(name: char, input: &str) -> Result<String, String> {
 
 // 安全地获取多项式字符串
 fn get_polynomial_string_safe(name: char) -> Result<String, String> {
-    unsafe {
-        let buffer_size = 1024;
-        let mut buffer = vec![0u8; buffer_size];
-        let result = get_polynomial_to_string(
-            name as std::os::raw::c_char,
-            buffer.as_mut_ptr() as *mut std::os::raw::c_char,
-            buffer_size as i32
-        );
-
-        match result {
-            0 => {
-                let c_str = CStr::from_ptr(buffer.as_ptr() as *const std::os::raw::c_char);
-                Ok(c_str.to_string_lossy().to_string())
-            },
-            -1 => Err("无效的多项式名称".to_string()),
-            -2 => Err("多项式不存在".to_string()),
-            _ => Err("未知错误".to_string())
-        }
+    if !('a'..='e').contains(&name) {
+        return Err("无效的多项式名称".to_string());
+    }
+    let c_name = CString::new(name.to_string()).map_err(|_| "Invalid name")?;
+    let result = read_text_output(|output, buffer_size, length| unsafe {
+        write_polynomial_string(c_name.as_ptr(), OUTPUT_STANDARD, output, buffer_size, length)
+    });
+
+    match result {
+        Ok(text) => Ok(text),
+        Err(-1) => Err("无效的多项式名称".to_string()),
+        Err(-2) => Err("多项式不存在".to_string()),
+        Err(_) => Err("未知错误".to_string())
     }
 }
 
 // 安全地计算多项式表达式
 fn calculate_polynomials_safe(expression: &str) -> Result<String, String> {
-    unsafe {
-        let c_expr = CString::new(expression).map_err(|_| "Invalid expression")?;
-        let buffer_size = 2048;
-        let mut buffer = vec![0u8; buffer_size];
-        let result = calculate_polynomials(
-            c_expr.as_ptr(),
-            buffer.as_mut_ptr() as *mut std::os::raw::c_char,
-            buffer_size as i32
-        );
-
-        match result {
-            0 => {
-                let c_str = CStr::from_ptr(buffer.as_ptr() as *const std::os::raw::c_char);
-                Ok(c_str.to_string_lossy().to_string())
-            },
-            -1 => Err("无效的多项式名称".to_string()),
-            -2 => Err("多项式不存在".to_string()),
-            -3 => Err("无效的输入".to_string()),
-            -4 => Err("多项式数量超过限制".to_string()),
-            -5 => Err("空表达式".to_string()),
-            -6 => Err("表达式解析错误".to_string()),
-            -7 => Err("无效表达式".to_string()),
-            -8 => Err("括号不匹配".to_string()),
-            -9 => Err("表达式中有无效字符".to_string()),
-            _ => Err("未知错误".to_string())
-        }
+    let c_expr = CString::new(expression).map_err(|_| "Invalid expression")?;
+    let result = read_text_output(|output, buffer_size, length| unsafe {
+        write_calculation_result(c_expr.as_ptr(), OUTPUT_STANDARD, output, buffer_size, length)
+    });
+
+    match result {
+        Ok(text) => Ok(text),
+        Err(-1) => Err("无效的多项式名称".to_string()),
+        Err(-2) => Err("多项式不存在".to_string()),
+        Err(-3) => Err("无效的输入".to_string()),
+        Err(-5) => Err("空表达式".to_string()),
+        Err(-6) => Err("表达式解析错误".to_string()),
+        Err(-7) => Err("无效表达式".to_string()),
+        Err(-8) => Err("括号不匹配".to_string()),
+        Err(-9) => Err("表达式中有无效字符".to_string()),
+        Err(_) => Err("未知错误".to_string())
     }
 }
 // 安全地计算多项式在x处的值
@@ -218,24 +237,15 @@ fn evaluate_polynomial_safe(name: char, x: i32) -> Result<i32, String> {
 
 // 安全地求多项式的导函数
 fn derivative_polynomial_safe(name: char) -> Result<String, String> {
-    unsafe {
-        let buffer_size = 1024;
-        let mut buffer = vec![0u8; buffer_size];
-        let result = derivative_polynomial(
-            name as std::os::raw::c_char,
-            buffer.as_mut_ptr() as *mut std::os::raw::c_char,
-            buffer_size as i32
-        );
-
-        match result {
-            0 => {
-                let c_str = CStr::from_ptr(buffer.as_ptr() as *const std::os::raw::c_char);
-                Ok(c_str.to_string_lossy().to_string())
-            },
-            -1 => Err("无效的多项式名称".to_string()),
-            -2 => Err("多项式不存在".to_string()),
-            _ => Err("未知错误".to_string())
-        }
+    let result = read_text_output(|output, buffer_size, length| unsafe {
+        write_derivative_result(name as std::os::raw::c_char, OUTPUT_STANDARD, output, buffer_size, length)
+    });
+
+    match result {
+        Ok(text) => Ok(text),
+        Err(-1) => Err("无效的多项式名称".to_string()),
+        Err(-2) => Err("多项式不存在".to_string()),
+        Err(_) => Err("未知错误".to_string())
     }
 }
 
@@ -295,106 +305,54 @@ fn get_polynomial_term_count_safe(name: char) -> Result<i32, String> {
 
 // 安全地获取多项式字符串（包含LaTeX格式）
 fn get_polynomial_string_with_latex_safe(name: char) -> Result<(String, String), String> {
-    unsafe {
-        let buffer_size = 2048;
-        let mut buffer = vec![0u8; buffer_size];
-        let result = get_polynomial_string_with_latex(
-            name as std::os::raw::c_char,
-            buffer.as_mut_ptr() as *mut std::os::raw::c_char,
-            buffer_size as i32
-        );
-
-        match result {
-            0 => {
-                let c_str = CStr::from_ptr(buffer.as_ptr() as *const std::os::raw::c_char);
-                let combined = c_str.to_string_lossy().to_string();
-
-                // Split by "|" to separate standard and LaTeX formats
-                if let Some(pipe_pos) = combined.find('|') {
-                    let standard = combined[..pipe_pos].to_string();
-                    let latex = combined[pipe_pos + 1..].to_string();
-                    Ok((standard, latex))
-                } else {
-                    // Fallback: treat as standard format only
-                    Ok((combined.clone(), combined))
-                }
-            },
-            -1 => Err("无效的多项式名称".to_string()),
-            -2 => Err("多项式不存在".to_string()),
-            _ => Err("未知错误".to_string())
-        }
+    if !('a'..='e').contains(&name) {
+        return Err("无效的多项式名称".to_string());
+    }
+    let c_name = CString::new(name.to_string()).map_err(|_| "Invalid name")?;
+    let result = read_text_output(|output, buffer_size, length| unsafe {
+        write_polynomial_string(c_name.as_ptr(), OUTPUT_WITH_LATEX, output, buffer_size, length)
+    });
+
+    match result {
+        Ok(combined) => Ok(split_latex_output(combined)),
+        Err(-1) => Err("无效的多项式名称".to_string()),
+        Err(-2) => Err("多项式不存在".to_string()),
+        Err(_) => Err("未知错误".to_string())
     }
 }
 
 // 安全地计算多项式表达式（包含LaTeX格式）
 fn calculate_polynomials_with_latex_safe(expression: &str) -> Result<(String, String), String> {
-    unsafe {
-        let c_expr = CString::new(expression).map_err(|_| "Invalid expression")?;
-        let buffer_size = 4096;
-        let mut buffer = vec![0u8; buffer_size];
-        let result = calculate_polynomials_with_latex(
-            c_expr.as_ptr(),
-            buffer.as_mut_ptr() as *mut std::os::raw::c_char,
-            buffer_size as i32
-        );
-
-        match result {
-            0 => {
-                let c_str = CStr::from_ptr(buffer.as_ptr() as *const std::os::raw::c_char);
-                let combined = c_str.to_string_lossy().to_string();
-
-                //  "|" 分割 standard and LaTeX formats
-                if let Some(pipe_pos) = combined.find('|') {
-                    let standard = combined[..pipe_pos].to_string();
-                    let latex = combined[pipe_pos + 1..].to_string();
-                    Ok((standard, latex))
-                } else {
-                    Ok((combined.clone(), combined))
-                }
-            },
-            -1 => Err("无效的多项式名称".to_string()),
-            -2 => Err("多项式不存在".to_string()),
-            -3 => Err("无效的输入".to_string()),
-            -4 => Err("多项式数量超过限制".to_string()),
-            -5 => Err("空表达式".to_string()),
-            -6 => Err("表达式解析错误".to_string()),
-            -7 => Err("无效表达式".to_string()),
-            -8 => Err("括号不匹配".to_string()),
-            -9 => Err("表达式中有无效字符".to_string()),
-            _ => Err("未知错误".to_string())
-        }
+    let c_expr = CString::new(expression).map_err(|_| "Invalid expression")?;
+    let result = read_text_output(|output, buffer_size, length| unsafe {
+        write_calculation_result(c_expr.as_ptr(), OUTPUT_WITH_LATEX, output, buffer_size, length)
+    });
+
+    match result {
+        Ok(combined) => Ok(split_latex_output(combined)),
+        Err(-1) => Err("无效的多项式名称".to_string()),
+        Err(-2) => Err("多项式不存在".to_string()),
+        Err(-3) => Err("无效的输入".to_string()),
+        Err(-5) => Err("空表达式".to_string()),
+        Err(-6) => Err("表达式解析错误".to_string()),
+        Err(-7) => Err("无效表达式".to_string()),
+        Err(-8) => Err("括号不匹配".to_string()),
+        Err(-9) => Err("表达式中有无效字符".to_string()),
+        Err(_) => Err("未知错误".to_string())
     }
 }
 
 /// 安全地求多项式的导函数（包含LaTeX格式）
 fn derivative_polynomial_with_latex_safe(name: char) -> Result<(String, String), String> {
-    unsafe {
-        let buffer_size = 2048;
-        let mut buffer = vec![0u8; buffer_size];
-        let result = derivative_polynomial_with_latex(
-            name as std::os::raw::c_char,
-            buffer.as_mut_ptr() as *mut std::os::raw::c_char,
-            buffer_size as i32
-        );
-
-        match result {
-            0 => {
-                let c_str = CStr::from_ptr(buffer.as_ptr() as *const std::os::raw::c_char);
-                let combined = c_str.to_string_lossy().to_string();
-
-                //  "|" 分割 standard and LaTeX formats
-                if let Some(pipe_pos) = combined.find('|') {
-                    let standard = combined[..pipe_pos].to_string();
-                    let latex = combined[pipe_pos + 1..].to_string();
-                    Ok((standard, latex))
-                } else {
-                    Ok((combined.clone(), combined))
-                }
-            },
-            -1 => Err("无效的多项式名称".to_string()),
-            -2 => Err("多项式不存在".to_string()),
-            _ => Err("未知错误".to_string())
-        }
+    let result = read_text_output(|output, buffer_size, length| unsafe {
+        write_derivative_result(name as std::os::raw::c_char, OUTPUT_WITH_LATEX, output, buffer_size, length)
+    });
+
+    match result {
+        Ok(combined) => Ok(split_latex_output(combined)),
+        Err(-1) => Err("无效的多项式名称".to_string()),
+        Err(-2) => Err("多项式不存在".to_string()),
+        Err(_) => Err("未知错误".to_string())
     }
 }
 